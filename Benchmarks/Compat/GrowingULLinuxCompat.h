@@ -0,0 +1,75 @@
+//
+//  GrowingULLinuxCompat.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Force-included into every file of the headless build; maps the Darwin-only APIs TrackerCore uses onto
+// Linux, libobjc2 and GNUstep-base. Not part of the shipped library.
+
+#ifndef GROWINGUL_LINUX_COMPAT_H
+#define GROWINGUL_LINUX_COMPAT_H
+
+#ifdef __OBJC__
+#import <Foundation/Foundation.h>
+#import <objc/runtime.h>
+#endif
+#include <dispatch/dispatch.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// GrowingULSwizzle.m checks the runtime generation, libobjc2 implements the ObjC 2 API
+#ifndef OBJC_API_VERSION
+#define OBJC_API_VERSION 2
+#endif
+
+#ifndef FOUNDATION_EXPORT
+#define FOUNDATION_EXPORT extern
+#endif
+
+#ifndef NS_NOESCAPE
+#define NS_NOESCAPE __attribute__((noescape))
+#endif
+
+#ifndef NSEC_PER_MSEC
+#define NSEC_PER_MSEC 1000000ull
+#endif
+
+// CLOCK_UPTIME_RAW stops while suspended on Darwin, like CLOCK_MONOTONIC on Linux
+#ifndef CLOCK_UPTIME_RAW
+#define CLOCK_UPTIME_RAW CLOCK_MONOTONIC
+#endif
+
+static inline uint64_t clock_gettime_nsec_np(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline int pthread_main_np(void) {
+    return getpid() == (pid_t)syscall(SYS_gettid);
+}
+
+#ifdef __OBJC__
+// GNUstep-base defines CGFloat but not CGSize; pass -DGROWINGUL_HAVE_CGSIZE when CoreGraphics types are available
+#ifndef GROWINGUL_HAVE_CGSIZE
+typedef NSSize CGSize;
+#endif
+#endif
+
+#endif
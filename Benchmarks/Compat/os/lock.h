@@ -0,0 +1,43 @@
+//
+//  lock.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// os_unfair_lock for headless builds: a test-and-set lock that yields while contended.
+
+#ifndef GROWINGUL_COMPAT_OS_LOCK_H
+#define GROWINGUL_COMPAT_OS_LOCK_H
+
+#include <sched.h>
+
+typedef struct {
+    int value;
+} os_unfair_lock, *os_unfair_lock_t;
+
+#define OS_UNFAIR_LOCK_INIT ((os_unfair_lock){0})
+
+static inline void os_unfair_lock_lock(os_unfair_lock_t lock) {
+    while (__atomic_exchange_n(&lock->value, 1, __ATOMIC_ACQUIRE)) {
+        sched_yield();
+    }
+}
+
+static inline void os_unfair_lock_unlock(os_unfair_lock_t lock) {
+    __atomic_store_n(&lock->value, 0, __ATOMIC_RELEASE);
+}
+
+#endif
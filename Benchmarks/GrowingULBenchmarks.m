@@ -0,0 +1,432 @@
+//
+//  GrowingULBenchmarks.m
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Prints one JSON document with ns/op and allocations/op for the TrackerCore hot paths, so that runs on
+// different commits can be diffed. Set GROWINGUL_BENCH_COMMIT to tag the output.
+
+#import <Foundation/Foundation.h>
+#import <objc/runtime.h>
+#import <stdatomic.h>
+#import "GrowingULClassTable.h"
+#import "GrowingULDelegateRegistry.h"
+#import "GrowingULEventJournal.h"
+#import "GrowingULStallMonitor.h"
+#import "GrowingULSwizzle.h"
+#import "GrowingULSwizzler.h"
+#import "GrowingULTimeUtil.h"
+
+#pragma mark - Allocation counting
+
+// glibc's internal entry points; every malloc family call of the process is counted
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+
+static atomic_ulong growingul_allocations;
+
+void *malloc(size_t size) {
+    atomic_fetch_add_explicit(&growingul_allocations, 1, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    atomic_fetch_add_explicit(&growingul_allocations, 1, memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+    atomic_fetch_add_explicit(&growingul_allocations, 1, memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+}
+
+#pragma mark - Runner
+
+typedef void (^GrowingULBenchmarkBody)(uint64_t iterations);
+
+static NSMutableArray<NSDictionary *> *growingul_results;
+
+static void GrowingULRunBenchmark(NSString *name, uint64_t iterations, GrowingULBenchmarkBody body) {
+    body(MAX(iterations / 100, 1));
+
+    unsigned long allocations = atomic_load(&growingul_allocations);
+    uint64_t start = GrowingULMonotonicTimeNanos();
+    body(iterations);
+    uint64_t elapsed = GrowingULMonotonicTimeNanos() - start;
+    allocations = atomic_load(&growingul_allocations) - allocations;
+
+    [growingul_results addObject:@{
+        @"name" : name,
+        @"iterations" : @(iterations),
+        @"ns_per_op" : @((double)elapsed / iterations),
+        @"allocs_per_op" : @((double)allocations / iterations),
+    }];
+}
+
+#pragma mark - Fixtures
+
+@interface GrowingULBenchmarkTarget : NSObject
+
+- (NSInteger)plain:(NSInteger)value;
+- (NSInteger)macroSwizzled:(NSInteger)value;
+- (NSInteger)invocationSwizzled:(NSInteger)value;
+- (NSInteger)factorySwizzled:(NSInteger)value;
+- (void)hook;
+
+@end
+
+@implementation GrowingULBenchmarkTarget
+
+- (NSInteger)plain:(NSInteger)value {
+    return value + 1;
+}
+
+- (NSInteger)macroSwizzled:(NSInteger)value {
+    return value + 1;
+}
+
+- (NSInteger)invocationSwizzled:(NSInteger)value {
+    return value + 1;
+}
+
+- (NSInteger)factorySwizzled:(NSInteger)value {
+    return value + 1;
+}
+
+- (void)hook {
+}
+
+@end
+
+@interface GrowingULBenchmarkDelegate : NSObject
+
+@property (nonatomic, assign) NSUInteger calls;
+
+- (void)applicationDidBecomeActive;
+
+@end
+
+@implementation GrowingULBenchmarkDelegate
+
+- (void)applicationDidBecomeActive {
+    _calls++;
+}
+
+@end
+
+static volatile NSInteger growingul_sink;
+
+// sum of the calls since the last take
+static NSUInteger GrowingULTakeDelegateCalls(NSArray<GrowingULBenchmarkDelegate *> *delegates) {
+    NSUInteger calls = 0;
+    for (GrowingULBenchmarkDelegate *delegate in delegates) {
+        calls += delegate.calls;
+        delegate.calls = 0;
+    }
+    return calls;
+}
+
+// the registry holds delegates weakly; a run that reached none of them measured an empty snapshot
+static void GrowingULRequireDelegateCalls(NSArray<GrowingULBenchmarkDelegate *> *delegates, NSString *name) {
+    if (GrowingULTakeDelegateCalls(delegates) == 0) {
+        fprintf(stderr, "%s: no delegate was called\n", name.UTF8String);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void GrowingULBenchmarkSwizzledCalls(void) {
+    GrowingULBenchmarkTarget *target = [[GrowingULBenchmarkTarget alloc] init];
+    const uint64_t iterations = 10000000;
+
+    GrowingULRunBenchmark(@"call.plain", iterations, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            growingul_sink = [target plain:(NSInteger)i];
+        }
+    });
+
+    GrowingULSwizzleInstanceMethod(GrowingULBenchmarkTarget,
+                                   @selector(macroSwizzled:),
+                                   GUSWReturnType(NSInteger),
+                                   GUSWArguments(NSInteger value),
+                                   GUSWReplacement({ return GUSWCallOriginal(value) + 1; }),
+                                   GrowingULSwizzleModeAlways,
+                                   NULL);
+    GrowingULRunBenchmark(@"call.swizzled.GUSWCallOriginal", iterations, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            growingul_sink = [target macroSwizzled:(NSInteger)i];
+        }
+    });
+    GrowingULSwizzleHook.instrumentationEnabled = YES;
+    GrowingULRunBenchmark(@"call.swizzled.instrumented", iterations, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            growingul_sink = [target macroSwizzled:(NSInteger)i];
+        }
+    });
+    GrowingULSwizzleHook.instrumentationEnabled = NO;
+    GrowingULSwizzleHook *hook = [GrowingULSwizzleHook hookForClass:GrowingULBenchmarkTarget.class
+                                                           selector:@selector(macroSwizzled:)];
+    [hook suspend];
+    GrowingULRunBenchmark(@"call.swizzled.suspended", iterations, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            growingul_sink = [target macroSwizzled:(NSInteger)i];
+        }
+    });
+    [hook resume];
+
+    __block NSInvocation *invocation = nil;
+    invocation = [GrowingULBenchmarkTarget growingul_swizzleMethod:@selector(invocationSwizzled:)
+                                                         withBlock:^NSInteger(id object, NSInteger value) {
+                                                             [invocation setArgument:&value atIndex:2];
+                                                             [invocation invokeWithTarget:object];
+                                                             NSInteger result = 0;
+                                                             [invocation getReturnValue:&result];
+                                                             return result + 1;
+                                                         }
+                                                             error:nil];
+    GrowingULRunBenchmark(@"call.swizzled.NSInvocation", iterations / 10, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            @autoreleasepool {
+                growingul_sink = [target invocationSwizzled:(NSInteger)i];
+            }
+        }
+    });
+
+    SEL factorySelector = @selector(factorySwizzled:);
+    [GrowingULBenchmarkTarget growingul_swizzleMethod:factorySelector
+                                     withBlockFactory:^id(IMP original) {
+                                         return ^NSInteger(id object, NSInteger value) {
+                                             return ((NSInteger(*)(id, SEL, NSInteger))original)(object,
+                                                                                                 factorySelector,
+                                                                                                 value) + 1;
+                                         };
+                                     }
+                                                error:nil];
+    GrowingULRunBenchmark(@"call.swizzled.blockFactory", iterations, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            growingul_sink = [target factorySwizzled:(NSInteger)i];
+        }
+    });
+}
+
+static void GrowingULBenchmarkDispatch(void) {
+    SEL selectors[] = {@selector(applicationDidBecomeActive)};
+    for (NSUInteger delegateCount = 1; delegateCount <= 64; delegateCount *= 8) {
+        GrowingULDelegateRegistry *registry = [[GrowingULDelegateRegistry alloc] initWithSelectors:selectors count:1];
+        NSMutableArray<GrowingULBenchmarkDelegate *> *delegates = [NSMutableArray array];
+        for (NSUInteger i = 0; i < delegateCount; i++) {
+            [delegates addObject:[[GrowingULBenchmarkDelegate alloc] init]];
+            [registry addDelegate:delegates.lastObject];
+        }
+        NSString *name = [NSString stringWithFormat:@"dispatch.delegates.%lu", (unsigned long)delegateCount];
+        GrowingULRunBenchmark(name, 1000000, ^(uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                [registry dispatchSelectorAtIndex:0];
+            }
+        });
+        GrowingULRequireDelegateCalls(delegates, name);
+
+        registry.latencyInstrumentationEnabled = YES;
+        NSString *instrumentedName = [name stringByAppendingString:@".instrumented"];
+        GrowingULRunBenchmark(instrumentedName, 1000000, ^(uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                [registry dispatchSelectorAtIndex:0];
+            }
+        });
+        GrowingULRequireDelegateCalls(delegates, instrumentedName);
+    }
+}
+
+static void GrowingULBenchmarkFilteredDispatch(void) {
+    SEL selectors[] = {@selector(applicationDidBecomeActive)};
+    GrowingULDelegateRegistry *registry = [[GrowingULDelegateRegistry alloc] initWithSelectors:selectors count:1];
+    GrowingULClassFilter *filter = [[GrowingULClassFilter alloc] init];
+    [filter excludeClassPrefix:@"GrowingULBenchmarkTarget"];
+    NSMutableArray<GrowingULBenchmarkDelegate *> *delegates = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 8; i++) {
+        [delegates addObject:[[GrowingULBenchmarkDelegate alloc] init]];
+        [registry addDelegate:delegates.lastObject classFilter:filter];
+    }
+    Class excluded = GrowingULBenchmarkTarget.class;
+    Class included = GrowingULBenchmarkDelegate.class;
+    GrowingULRunBenchmark(@"dispatch.filtered.excluded", 1000000, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            uint64_t audience = [registry audienceForClass:excluded];
+            if (audience) {
+                [registry dispatchSelectorAtIndex:0 withObject:nil audience:audience];
+            }
+        }
+    });
+    GrowingULTakeDelegateCalls(delegates);
+    GrowingULRunBenchmark(@"dispatch.filtered.included", 1000000, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            uint64_t audience = [registry audienceForClass:included];
+            if (audience) {
+                [registry dispatchSelectorAtIndex:0 withObject:nil audience:audience];
+            }
+        }
+    });
+    GrowingULRequireDelegateCalls(delegates, @"dispatch.filtered.included");
+}
+
+static void GrowingULBenchmarkSwizzleManyClasses(void) {
+    const NSUInteger classCount = 2000;
+    Class *classes = malloc(sizeof(Class) * classCount);
+    for (NSUInteger i = 0; i < classCount; i++) {
+        NSString *name = [NSString stringWithFormat:@"GrowingULBenchmarkSubclass%lu", (unsigned long)i];
+        classes[i] = objc_allocateClassPair(GrowingULBenchmarkTarget.class, name.UTF8String, 0);
+        objc_registerClassPair(classes[i]);
+    }
+
+    static const void *key = &key;
+    GrowingULSwizzleImpFactoryBlock factory = ^id(GrowingULSwizzleInfo *swizzleInfo) {
+        return ^(__unsafe_unretained id object) {
+            ((void (*)(id, SEL))[swizzleInfo getOriginalImplementation])(object, @selector(hook));
+        };
+    };
+    __block NSUInteger next = 0;
+    GrowingULRunBenchmark(@"swizzleInstanceMethod.firstPerClass", classCount, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n && next < classCount; i++, next++) {
+            [GrowingULSwizzle swizzleInstanceMethod:@selector(hook)
+                                            inClass:classes[next]
+                                      newImpFactory:factory
+                                               mode:GrowingULSwizzleModeOncePerClassAndSuperclasses
+                                                key:key];
+        }
+    });
+    GrowingULRunBenchmark(@"swizzleInstanceMethod.alreadySwizzled", 100000, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            [GrowingULSwizzle swizzleInstanceMethod:@selector(hook)
+                                            inClass:classes[i % classCount]
+                                      newImpFactory:factory
+                                               mode:GrowingULSwizzleModeOncePerClassAndSuperclasses
+                                                key:key];
+        }
+    });
+    free(classes);
+}
+
+static void GrowingULBenchmarkClocks(void) {
+    const uint64_t iterations = 10000000;
+    GrowingULRunBenchmark(@"clock.GrowingULMonotonicTimeNanos", iterations, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            growingul_sink = (NSInteger)GrowingULMonotonicTimeNanos();
+        }
+    });
+    GrowingULRunBenchmark(@"clock.GrowingULEstimatedWallTimeNanos", iterations, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            growingul_sink = (NSInteger)GrowingULEstimatedWallTimeNanos();
+        }
+    });
+    GrowingULRunBenchmark(@"clock.currentSystemTimeMillis", iterations, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            growingul_sink = (NSInteger)[GrowingULTimeUtil currentSystemTimeMillis];
+        }
+    });
+    GrowingULRunBenchmark(@"clock.currentTimeMillis", iterations, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            growingul_sink = (NSInteger)[GrowingULTimeUtil currentTimeMillis];
+        }
+    });
+    // what currentTimeMillis cost before it read the clock directly
+    GrowingULRunBenchmark(@"clock.NSDate", iterations / 10, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            @autoreleasepool {
+                growingul_sink = (NSInteger)([[NSDate date] timeIntervalSince1970] * 1000);
+            }
+        }
+    });
+}
+
+static void GrowingULBenchmarkClassNames(void) {
+    const uint64_t iterations = 10000000;
+    Class cls = GrowingULBenchmarkTarget.class;
+    GrowingULClassId classId = GrowingULClassIdForClass(cls);
+    GrowingULRunBenchmark(@"classTable.nameForId", iterations, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            growingul_sink = (NSInteger)(__bridge void *)GrowingULClassNameForId(classId);
+        }
+    });
+    GrowingULRunBenchmark(@"classTable.nameForClass", iterations, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            growingul_sink = (NSInteger)(__bridge void *)GrowingULClassNameForClass(cls);
+        }
+    });
+    // what page names cost the delegates before the table
+    GrowingULRunBenchmark(@"classTable.NSStringFromClass", iterations / 10, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            @autoreleasepool {
+                growingul_sink = (NSInteger)NSStringFromClass(cls).length;
+            }
+        }
+    });
+}
+
+static void GrowingULBenchmarkJournal(void) {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"growingul-bench.journal"];
+    GrowingULEventJournal *journal = [[GrowingULEventJournal alloc] initWithPath:path capacity:4096 error:nil];
+    GrowingULLifecycleEvent event = {
+        .type = GrowingULLifecycleEventTypeViewControllerDidAppear,
+        .timestamp = [GrowingULTimeUtil currentSystemTimeMillis],
+        .objectClass = GrowingULBenchmarkTarget.class,
+        .objectIdentity = &event,
+    };
+    GrowingULRunBenchmark(@"journal.append", 10000000, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            [journal appendEvent:&event];
+        }
+    });
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+// what the hubs pay per event for stall attribution; the run loop observer needs CFRunLoop and is not measured here
+static void GrowingULBenchmarkStallMonitor(void) {
+    GrowingULStallMonitor *monitor = [[GrowingULStallMonitor alloc] init];
+    GrowingULLifecycleEvent event = {
+        .type = GrowingULLifecycleEventTypeViewControllerDidAppear,
+        .classId = GrowingULClassIdForClass(GrowingULBenchmarkTarget.class),
+    };
+    GrowingULRunBenchmark(@"stallMonitor.recordEvent", 10000000, ^(uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            [monitor recordEvent:&event];
+        }
+    });
+}
+
+int main(int argc, const char *argv[]) {
+    @autoreleasepool {
+        growingul_results = [NSMutableArray array];
+        GrowingULBenchmarkSwizzledCalls();
+        GrowingULBenchmarkDispatch();
+        GrowingULBenchmarkFilteredDispatch();
+        GrowingULBenchmarkSwizzleManyClasses();
+        GrowingULBenchmarkClocks();
+        GrowingULBenchmarkClassNames();
+        GrowingULBenchmarkJournal();
+        GrowingULBenchmarkStallMonitor();
+
+        const char *commit = getenv("GROWINGUL_BENCH_COMMIT");
+        NSDictionary *report = @{
+            @"commit" : commit ? @(commit) : [NSNull null],
+            @"results" : growingul_results,
+        };
+        NSData *json = [NSJSONSerialization dataWithJSONObject:report options:NSJSONWritingPrettyPrinted error:nil];
+        fwrite(json.bytes, 1, json.length, stdout);
+        fputc('\n', stdout);
+    }
+    return 0;
+}
@@ -23,12 +23,32 @@
 #import "GrowingULViewControllerLifecycle.h"
 #import "GrowingULTimeUtil.h"
 #import "GrowingULSwizzle.h"
+#import "GrowingULDelegateRegistry.h"
+#import "GrowingULPageStateTable.h"
+#import "GrowingULRunLoopIdle.h"
+#import "GrowingULLaunchTimeline.h"
+#import "UIApplication+GrowingUtilsTrackerCore.h"
 #import <objc/runtime.h>
+#import <stdatomic.h>
+
+typedef NS_ENUM(NSUInteger, GrowingULViewControllerCallback) {
+    GrowingULViewControllerCallbackLoadView = 0,
+    GrowingULViewControllerCallbackDidLoad,
+    GrowingULViewControllerCallbackWillAppear,
+    GrowingULViewControllerCallbackIsAppearing,
+    GrowingULViewControllerCallbackDidAppear,
+    GrowingULViewControllerCallbackWillDisappear,
+    GrowingULViewControllerCallbackDidDisappear,
+    GrowingULViewControllerCallbackDidRender,
+    GrowingULViewControllerCallbackCount
+};
 
 @interface GrowingULViewControllerLifecycle ()
 
-@property (strong, nonatomic, readonly) NSPointerArray *lifecycleDelegates;
-@property (strong, nonatomic, readonly) NSLock *delegateLock;
+@property (strong, nonatomic, readonly) GrowingULDelegateRegistry *delegateRegistry;
+@property (strong, nonatomic, readonly) GrowingULPageStateTable *pageStateTable;
+// keeps the controllers of pending batched events alive until the batch is delivered
+@property (strong, nonatomic, readonly) NSMutableArray<UIViewController *> *batchedControllers;
 
 - (void)dispatchViewControllerLoadView:(UIViewController *)controller;
 - (void)dispatchViewControllerDidLoad:(UIViewController *)controller;
@@ -40,61 +60,218 @@
 
 @end
 
+// filled by setupPageStateNotification:, for GrowingULSwizzleHook instrumentation
+static __unsafe_unretained GrowingULSwizzleHook *growingul_pageStateHooks[GrowingULViewControllerCallbackCount];
+
+// The hooks are normally taken out while suspended; the checks cover hooks that another library captured by
+// pointer, which can only pass through.
 @implementation UIViewController (GrowingUtilsAutotrackerCore)
 
 - (void)growingul_loadView {
     [self growingul_loadView];
+    if (GrowingULSwizzleHooksSuspended()) {
+        return;
+    }
+    GrowingULSwizzleHookEnterScope(growingul_pageStateHooks[GrowingULViewControllerCallbackLoadView]);
     [[GrowingULViewControllerLifecycle sharedInstance] dispatchViewControllerLoadView:self];
 }
 
 - (void)growingul_viewDidLoad {
     [self growingul_viewDidLoad];
+    if (GrowingULSwizzleHooksSuspended()) {
+        return;
+    }
+    GrowingULSwizzleHookEnterScope(growingul_pageStateHooks[GrowingULViewControllerCallbackDidLoad]);
     [[GrowingULViewControllerLifecycle sharedInstance] dispatchViewControllerDidLoad:self];
 }
 
 - (void)growingul_viewWillAppear:(BOOL)animated {
     [self growingul_viewWillAppear:animated];
+    if (GrowingULSwizzleHooksSuspended()) {
+        return;
+    }
+    GrowingULSwizzleHookEnterScope(growingul_pageStateHooks[GrowingULViewControllerCallbackWillAppear]);
     [[GrowingULViewControllerLifecycle sharedInstance] dispatchViewControllerWillAppear:self];
 }
 
 - (void)growingul_viewIsAppearing:(BOOL)animated {
     [self growingul_viewIsAppearing:animated];
+    if (GrowingULSwizzleHooksSuspended()) {
+        return;
+    }
+    GrowingULSwizzleHookEnterScope(growingul_pageStateHooks[GrowingULViewControllerCallbackIsAppearing]);
     [[GrowingULViewControllerLifecycle sharedInstance] dispatchViewControllerIsAppearing:self];
 }
 
 - (void)growingul_viewDidAppear:(BOOL)animated {
     [self growingul_viewDidAppear:animated];
-    self.growingul_didAppear = YES;
+    if (GrowingULSwizzleHooksSuspended()) {
+        return;
+    }
+    GrowingULSwizzleHookEnterScope(growingul_pageStateHooks[GrowingULViewControllerCallbackDidAppear]);
     [[GrowingULViewControllerLifecycle sharedInstance] dispatchViewControllerDidAppear:self];
 }
 
 - (void)growingul_viewWillDisappear:(BOOL)animated {
     [self growingul_viewWillDisappear:animated];
+    if (GrowingULSwizzleHooksSuspended()) {
+        return;
+    }
+    GrowingULSwizzleHookEnterScope(growingul_pageStateHooks[GrowingULViewControllerCallbackWillDisappear]);
     [GrowingULViewControllerLifecycle.sharedInstance dispatchViewControllerWillDisappear:self];
 }
 
 - (void)growingul_viewDidDisappear:(BOOL)animated {
     [self growingul_viewDidDisappear:animated];
+    if (GrowingULSwizzleHooksSuspended()) {
+        return;
+    }
+    GrowingULSwizzleHookEnterScope(growingul_pageStateHooks[GrowingULViewControllerCallbackDidDisappear]);
     [GrowingULViewControllerLifecycle.sharedInstance dispatchViewControllerDidDisappear:self];
 }
 
 - (BOOL)growingul_didAppear {
-    return ((NSNumber *)objc_getAssociatedObject(self, _cmd)).boolValue;
+    GrowingULPageState state;
+    [[GrowingULPageStateTable sharedTable] getState:&state forController:self];
+    return state.didAppear;
 }
 
 - (void)setGrowingul_didAppear:(BOOL)didAppear {
-    objc_setAssociatedObject(self, @selector(growingul_didAppear), @(didAppear), OBJC_ASSOCIATION_COPY_NONATOMIC);
+    [[GrowingULPageStateTable sharedTable] setDidAppear:didAppear forController:self];
+}
+
+@end
+
+static BOOL GrowingULIsTransientAppearance(GrowingULLifecycleEventType type) {
+    return type == GrowingULLifecycleEventTypeViewControllerIsAppearing ||
+           type == GrowingULLifecycleEventTypeViewControllerWillDisappear;
+}
+
+// Removes willAppear -> (isAppearing) -> willDisappear -> didDisappear runs of controllers that never reached
+// viewDidAppear (e.g. a cancelled interactive pop). Returns the new count.
+static NSUInteger GrowingULFoldTransientAppearances(GrowingULLifecycleEvent *events, NSUInteger count) {
+    BOOL *dropped = calloc(MAX(count, 1), sizeof(BOOL));
+    for (NSUInteger i = 0; i < count; i++) {
+        if (dropped[i] || events[i].type != GrowingULLifecycleEventTypeViewControllerWillAppear) {
+            continue;
+        }
+        const void *identity = events[i].objectIdentity;
+        NSUInteger end = NSNotFound;
+        for (NSUInteger j = i + 1; j < count; j++) {
+            if (events[j].objectIdentity != identity) {
+                continue;
+            }
+            if (events[j].type == GrowingULLifecycleEventTypeViewControllerDidDisappear) {
+                end = j;
+            }
+            if (!GrowingULIsTransientAppearance(events[j].type)) {
+                break;
+            }
+        }
+        if (end == NSNotFound) {
+            continue;
+        }
+        for (NSUInteger j = i; j <= end; j++) {
+            if (events[j].objectIdentity == identity) {
+                dropped[j] = YES;
+            }
+        }
+    }
+
+    NSUInteger folded = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        if (!dropped[i]) {
+            events[folded++] = events[i];
+        }
+    }
+    free(dropped);
+    return folded;
+}
+
+static GrowingULViewControllerCallback GrowingULViewControllerCallbackForEventType(GrowingULLifecycleEventType type) {
+    switch (type) {
+        case GrowingULLifecycleEventTypeViewControllerLoadView:
+            return GrowingULViewControllerCallbackLoadView;
+        case GrowingULLifecycleEventTypeViewControllerDidLoad:
+            return GrowingULViewControllerCallbackDidLoad;
+        case GrowingULLifecycleEventTypeViewControllerWillAppear:
+            return GrowingULViewControllerCallbackWillAppear;
+        case GrowingULLifecycleEventTypeViewControllerIsAppearing:
+            return GrowingULViewControllerCallbackIsAppearing;
+        case GrowingULLifecycleEventTypeViewControllerDidAppear:
+            return GrowingULViewControllerCallbackDidAppear;
+        case GrowingULLifecycleEventTypeViewControllerWillDisappear:
+            return GrowingULViewControllerCallbackWillDisappear;
+        default:
+            return GrowingULViewControllerCallbackDidDisappear;
+    }
+}
+
+static GrowingULLifecycleEvent GrowingULViewControllerEventMake(GrowingULLifecycleEventType type,
+                                                               UIViewController *controller,
+                                                               double timestamp) {
+    Class controllerClass = object_getClass(controller);
+    GrowingULClassId classId = GrowingULClassIdForClass(controllerClass);
+    return (GrowingULLifecycleEvent){
+        .type = type,
+        .classId = classId,
+        .timestamp = timestamp,
+        .objectClass = controllerClass,
+        .objectClassName = GrowingULClassNameForId(classId),
+        .objectIdentity = (__bridge const void *)controller,
+    };
 }
 
+// An event seen while a staged setup is pending, delivered once the setup completes.
+@interface GrowingULEarlyPageEvent : NSObject
+
+@property (nonatomic, assign) GrowingULLifecycleEventType type;
+@property (nonatomic, strong) UIViewController *controller;
+@property (nonatomic, assign) double timestamp;
+@property (nonatomic, assign) BOOL measured;
+@property (nonatomic, assign) GrowingULPageRenderTiming timing;
+
+@end
+
+@implementation GrowingULEarlyPageEvent
 @end
 
-@implementation GrowingULViewControllerLifecycle
+typedef NS_OPTIONS(NSUInteger, GrowingULPageStateHooks) {
+    // viewWillAppear: and viewDidAppear:, installed right away by a staged setup
+    GrowingULPageStateHooksAppearance = 1 << 0,
+    GrowingULPageStateHooksOthers = 1 << 1,
+};
+
+@implementation GrowingULViewControllerLifecycle {
+    atomic_bool _setupCompleted;
+    // set while a staged setup is pending; _earlyEvents is main thread only
+    atomic_bool _bufferingEarlyEvents;
+    NSMutableArray<GrowingULEarlyPageEvent *> *_earlyEvents;
+    // main thread only
+    GrowingULLifecycleEvent *_batchedEvents;
+    NSUInteger _batchedEventCount;
+    NSUInteger _batchedEventCapacity;
+    BOOL _batchFlushScheduled;
+    CFRunLoopObserverRef _batchObserver;
+}
 
 - (instancetype)init {
     self = [super init];
     if (self) {
-        _lifecycleDelegates = [NSPointerArray pointerArrayWithOptions:NSPointerFunctionsWeakMemory];
-        _delegateLock = [[NSLock alloc] init];
+        SEL selectors[GrowingULViewControllerCallbackCount] = {
+            [GrowingULViewControllerCallbackLoadView] = @selector(viewControllerLoadView:),
+            [GrowingULViewControllerCallbackDidLoad] = @selector(viewControllerDidLoad:),
+            [GrowingULViewControllerCallbackWillAppear] = @selector(viewControllerWillAppear:),
+            [GrowingULViewControllerCallbackIsAppearing] = @selector(viewControllerIsAppearing:),
+            [GrowingULViewControllerCallbackDidAppear] = @selector(viewControllerDidAppear:),
+            [GrowingULViewControllerCallbackWillDisappear] = @selector(viewControllerWillDisappear:),
+            [GrowingULViewControllerCallbackDidDisappear] = @selector(viewControllerDidDisappear:),
+            [GrowingULViewControllerCallbackDidRender] = @selector(viewControllerDidRender:),
+        };
+        _delegateRegistry = [[GrowingULDelegateRegistry alloc] initWithSelectors:selectors
+                                                                           count:GrowingULViewControllerCallbackCount];
+        _batchedControllers = [NSMutableArray array];
+        _pageStateTable = [GrowingULPageStateTable sharedTable];
     }
 
     return self;
@@ -111,161 +288,341 @@
 }
 
 + (void)setup {
+    [self setupWithMode:GrowingULSetupModeImmediate];
+}
+
++ (void)setupWithMode:(GrowingULSetupMode)mode {
+    NSAssert(mode != GrowingULSetupModeStaged || NSThread.isMainThread, @"staged setup must run on the main thread");
+    if (!NSThread.isMainThread) {
+        mode = GrowingULSetupModeImmediate;
+    }
+    GrowingULViewControllerLifecycle *lifecycle = [self sharedInstance];
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
-        [[self sharedInstance] setupPageStateNotification];
+        uint64_t start = GrowingULMonotonicTimeNanos();
+        lifecycle->_setupMode = mode;
+        GrowingULLaunchTimelineExpectPageAppearance();
+        if (mode == GrowingULSetupModeStaged) {
+            lifecycle->_earlyEvents = [NSMutableArray array];
+            atomic_store(&lifecycle->_bufferingEarlyEvents, true);
+            [lifecycle setupPageStateNotification:GrowingULPageStateHooksAppearance];
+            GrowingULPerformWhenMainRunLoopIdle(^{
+                [lifecycle completeSetup];
+            });
+        } else {
+            [lifecycle completeSetup];
+        }
+        lifecycle->_setupNanos = GrowingULMonotonicTimeNanos() - start;
     });
+    if (mode == GrowingULSetupModeImmediate) {
+        // an immediate setup after a staged one does not wait for the run loop; the early buffer is main thread only
+        if (NSThread.isMainThread) {
+            [lifecycle completeSetup];
+        } else {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [lifecycle completeSetup];
+            });
+        }
+    }
 }
 
-- (void)setupPageStateNotification {
-    [UIViewController growingul_swizzleMethod:@selector(loadView)
-                                   withMethod:@selector(growingul_loadView)
-                                        error:nil];
-
-    [UIViewController growingul_swizzleMethod:@selector(viewDidLoad)
-                                   withMethod:@selector(growingul_viewDidLoad)
-                                        error:nil];
-
-    [UIViewController growingul_swizzleMethod:@selector(viewWillAppear:)
-                                   withMethod:@selector(growingul_viewWillAppear:)
-                                        error:nil];
-
-    [UIViewController growingul_swizzleMethod:@selector(viewDidAppear:)
-                                   withMethod:@selector(growingul_viewDidAppear:)
-                                        error:nil];
-
-    [UIViewController growingul_swizzleMethod:@selector(viewWillDisappear:)
-                                   withMethod:@selector(growingul_viewWillDisappear:)
-                                        error:nil];
-
-    [UIViewController growingul_swizzleMethod:@selector(viewDidDisappear:)
-                                   withMethod:@selector(growingul_viewDidDisappear:)
-                                        error:nil];
-    
-    if (@available(iOS 13.0, *)) {
-        SEL selector = NSSelectorFromString(@"viewIsAppearing:");
-        if ([UIViewController instancesRespondToSelector:selector]) {
-            [UIViewController growingul_swizzleMethod:selector
-                                           withMethod:@selector(growingul_viewIsAppearing:)
-                                                error:nil];
+- (void)completeSetup {
+    if (atomic_exchange(&_setupCompleted, true)) {
+        return;
+    }
+    uint64_t start = GrowingULMonotonicTimeNanos();
+    BOOL staged = _earlyEvents != nil;
+    [self setupPageStateNotification:staged ? GrowingULPageStateHooksOthers
+                                            : GrowingULPageStateHooksAppearance | GrowingULPageStateHooksOthers];
+    GrowingULEnableTopViewControllerCache();
+
+    // delegates may cause new events while the early ones are replayed; those are delivered directly
+    NSArray<GrowingULEarlyPageEvent *> *earlyEvents = _earlyEvents;
+    _earlyEvents = nil;
+    atomic_store(&_bufferingEarlyEvents, false);
+    for (GrowingULEarlyPageEvent *event in earlyEvents) {
+        GrowingULPageRenderTiming timing = event.timing;
+        [self deliverEventWithType:event.type
+                        controller:event.controller
+                            timing:event.measured ? &timing : NULL
+                         timestamp:event.timestamp];
+    }
+
+    if (staged) {
+        _deferredSetupNanos = GrowingULMonotonicTimeNanos() - start;
+    }
+    _setupCompletedTime = [GrowingULTimeUtil currentSystemTimeMillis];
+}
+
+- (void)setupPageStateNotification:(GrowingULPageStateHooks)hooks {
+    Class cls = UIViewController.class;
+    GrowingULSwizzleEntry entries[7];
+    GrowingULViewControllerCallback callbacks[7];
+    NSUInteger count = 0;
+    if (hooks & GrowingULPageStateHooksAppearance) {
+        callbacks[count] = GrowingULViewControllerCallbackWillAppear;
+        entries[count++] =
+            (GrowingULSwizzleEntry){cls, @selector(viewWillAppear:), @selector(growingul_viewWillAppear:)};
+        callbacks[count] = GrowingULViewControllerCallbackDidAppear;
+        entries[count++] = (GrowingULSwizzleEntry){cls, @selector(viewDidAppear:), @selector(growingul_viewDidAppear:)};
+    }
+    if (hooks & GrowingULPageStateHooksOthers) {
+        callbacks[count] = GrowingULViewControllerCallbackLoadView;
+        entries[count++] = (GrowingULSwizzleEntry){cls, @selector(loadView), @selector(growingul_loadView)};
+        callbacks[count] = GrowingULViewControllerCallbackDidLoad;
+        entries[count++] = (GrowingULSwizzleEntry){cls, @selector(viewDidLoad), @selector(growingul_viewDidLoad)};
+        callbacks[count] = GrowingULViewControllerCallbackWillDisappear;
+        entries[count++] =
+            (GrowingULSwizzleEntry){cls, @selector(viewWillDisappear:), @selector(growingul_viewWillDisappear:)};
+        callbacks[count] = GrowingULViewControllerCallbackDidDisappear;
+        entries[count++] =
+            (GrowingULSwizzleEntry){cls, @selector(viewDidDisappear:), @selector(growingul_viewDidDisappear:)};
+        if (@available(iOS 13.0, *)) {
+            SEL selector = NSSelectorFromString(@"viewIsAppearing:");
+            if ([UIViewController instancesRespondToSelector:selector]) {
+                callbacks[count] = GrowingULViewControllerCallbackIsAppearing;
+                entries[count++] = (GrowingULSwizzleEntry){cls, selector, @selector(growingul_viewIsAppearing:)};
+            }
         }
     }
+
+    if (GrowingULSwizzleMethods(entries, count, nil)) {
+        for (NSUInteger i = 0; i < count; i++) {
+            growingul_pageStateHooks[callbacks[i]] = entries[i].hook;
+        }
+    }
+}
+
+- (BOOL)isLatencyInstrumentationEnabled {
+    return self.delegateRegistry.latencyInstrumentationEnabled;
+}
+
+- (void)setLatencyInstrumentationEnabled:(BOOL)latencyInstrumentationEnabled {
+    self.delegateRegistry.latencyInstrumentationEnabled = latencyInstrumentationEnabled;
+}
+
+- (NSArray<GrowingULDelegateLatency *> *)delegateLatencySnapshot {
+    return [self.delegateRegistry latencySnapshot];
+}
+
+- (GrowingULPageRenderStatistics)renderStatisticsForControllerClass:(Class)controllerClass {
+    return [self.pageStateTable renderStatisticsForControllerClass:controllerClass];
+}
+
+- (void)enumerateRenderStatisticsUsingBlock:(void (NS_NOESCAPE ^)(Class controllerClass,
+                                                                  GrowingULPageRenderStatistics statistics))block {
+    [self.pageStateTable enumerateRenderStatisticsUsingBlock:block];
+}
+
+- (NSUInteger)droppedEventCount {
+    return self.delegateRegistry.droppedEventCount;
+}
+
+- (void)setDeliveryMode:(GrowingULLifecycleDeliveryMode)deliveryMode {
+    _deliveryMode = deliveryMode;
+    self.delegateRegistry.asynchronousDelivery = (deliveryMode == GrowingULLifecycleDeliveryModeAsynchronous);
 }
 
 - (void)addViewControllerLifecycleDelegate:(id<GrowingULViewControllerLifecycleDelegate>)delegate {
-    [self.delegateLock lock];
-    if (![self.lifecycleDelegates.allObjects containsObject:delegate]) {
-        [self.lifecycleDelegates addPointer:(__bridge void *)delegate];
-    }
-    [self.delegateLock unlock];
+    [self.delegateRegistry addDelegate:delegate];
+}
+
+- (void)addViewControllerLifecycleDelegate:(id<GrowingULViewControllerLifecycleDelegate>)delegate
+                               classFilter:(GrowingULClassFilter *)filter {
+    [self.delegateRegistry addDelegate:delegate classFilter:filter];
 }
 
 - (void)removeViewControllerLifecycleDelegate:(id<GrowingULViewControllerLifecycleDelegate>)delegate {
-    [self.delegateLock lock];
-    [self.lifecycleDelegates.allObjects enumerateObjectsWithOptions:NSEnumerationReverse
-                                                         usingBlock:^(NSObject *obj,
-                                                                      NSUInteger idx,
-                                                                      BOOL *_Nonnull stop) {
-        if (delegate == obj) {
-            [self.lifecycleDelegates removePointerAtIndex:idx];
-            *stop = YES;
-        }
-    }];
-        
-    [self.delegateLock unlock];
+    [self.delegateRegistry removeDelegate:delegate];
 }
 
-- (void)dispatchViewControllerLoadView:(UIViewController *)controller {
-    if (controller == nil) {
+- (void)setBatchingEnabled:(BOOL)batchingEnabled {
+    NSAssert(NSThread.isMainThread, @"batching must be configured on the main thread");
+    if (_batchingEnabled == batchingEnabled) {
         return;
     }
-    [self.delegateLock lock];
-    for (id delegate in self.lifecycleDelegates) {
-        if ([delegate respondsToSelector:@selector(viewControllerLoadView:)]) {
-            [delegate viewControllerLoadView:controller];
-        }
+
+    if (batchingEnabled) {
+        _batchingEnabled = YES;
+        self.delegateRegistry.batchedDelivery = YES;
+        // Repeating and ordered after Core Animation's commit, so events emitted anywhere in the turn are delivered
+        // before the run loop goes to sleep.
+        __weak typeof(self) weakSelf = self;
+        _batchObserver = CFRunLoopObserverCreateWithHandler(kCFAllocatorDefault,
+                                                            kCFRunLoopBeforeWaiting | kCFRunLoopExit,
+                                                            true,
+                                                            LONG_MAX,
+                                                            ^(CFRunLoopObserverRef observer, CFRunLoopActivity activity) {
+            __strong typeof(weakSelf) strongSelf = weakSelf;
+            if (strongSelf && strongSelf.batchInterval <= 0) {
+                [strongSelf flushBatchedEvents];
+            }
+        });
+        CFRunLoopAddObserver(CFRunLoopGetMain(), _batchObserver, kCFRunLoopCommonModes);
+    } else {
+        CFRunLoopObserverInvalidate(_batchObserver);
+        CFRelease(_batchObserver);
+        _batchObserver = NULL;
+        self.delegateRegistry.batchedDelivery = NO;
+        [self flushBatchedEvents];
+        _batchingEnabled = NO;
     }
-    [self.delegateLock unlock];
 }
 
-- (void)dispatchViewControllerDidLoad:(UIViewController *)controller {
-    if (controller == nil) {
+// timestamp 0 stands for now
+- (void)postEventWithType:(GrowingULLifecycleEventType)type
+               controller:(UIViewController *)controller
+                timestamp:(double)timestamp {
+    BOOL asynchronous = self.delegateRegistry.asynchronousDelivery;
+    BOOL batched = _batchingEnabled;
+    if (!asynchronous && !batched) {
         return;
     }
-    [self.delegateLock lock];
-    for (id delegate in self.lifecycleDelegates) {
-        if ([delegate respondsToSelector:@selector(viewControllerDidLoad:)]) {
-            [delegate viewControllerDidLoad:controller];
-        }
+    GrowingULLifecycleEvent event = GrowingULViewControllerEventMake(
+        type, controller, timestamp > 0 ? timestamp : [GrowingULTimeUtil currentSystemTimeMillis]);
+    if (asynchronous) {
+        [self.delegateRegistry postEvent:event];
+    }
+    if (batched) {
+        [self enqueueBatchedEvent:event controller:controller];
     }
-    [self.delegateLock unlock];
 }
 
-- (void)dispatchViewControllerWillAppear:(UIViewController *)controller {
-    if (controller == nil) {
+- (void)enqueueBatchedEvent:(GrowingULLifecycleEvent)event controller:(UIViewController *)controller {
+    if (!NSThread.isMainThread) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self enqueueBatchedEvent:event controller:controller];
+        });
         return;
     }
-    [self.delegateLock lock];
-    for (id delegate in self.lifecycleDelegates) {
-        if ([delegate respondsToSelector:@selector(viewControllerWillAppear:)]) {
-            [delegate viewControllerWillAppear:controller];
-        }
+
+    if (_batchedEventCount == _batchedEventCapacity) {
+        _batchedEventCapacity = MAX(_batchedEventCapacity * 2, 16);
+        _batchedEvents = realloc(_batchedEvents, _batchedEventCapacity * sizeof(GrowingULLifecycleEvent));
+    }
+    _batchedEvents[_batchedEventCount++] = event;
+    [self.batchedControllers addObject:controller];
+
+    if (self.batchInterval > 0 && !_batchFlushScheduled) {
+        _batchFlushScheduled = YES;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.batchInterval * NSEC_PER_SEC)),
+                       dispatch_get_main_queue(),
+                       ^{
+            [self flushBatchedEvents];
+        });
     }
-    [self.delegateLock unlock];
 }
 
-- (void)dispatchViewControllerIsAppearing:(UIViewController *)controller {
-    if (controller == nil) {
+- (void)flushBatchedEvents {
+    _batchFlushScheduled = NO;
+    if (_batchedEventCount == 0) {
         return;
     }
-    [self.delegateLock lock];
-    for (id delegate in self.lifecycleDelegates) {
-        if ([delegate respondsToSelector:@selector(viewControllerIsAppearing:)]) {
-            [delegate viewControllerIsAppearing:controller];
-        }
+
+    // Detach the batch first, delegates may trigger new lifecycle events while handling it.
+    GrowingULLifecycleEvent *events = _batchedEvents;
+    NSUInteger count = _batchedEventCount;
+    __attribute__((objc_precise_lifetime)) NSArray *controllers = [self.batchedControllers copy];
+    _batchedEvents = NULL;
+    _batchedEventCount = 0;
+    _batchedEventCapacity = 0;
+    [self.batchedControllers removeAllObjects];
+
+    if (self.foldsTransientAppearances) {
+        count = GrowingULFoldTransientAppearances(events, count);
     }
-    [self.delegateLock unlock];
+    [self.delegateRegistry dispatchEvents:events count:count];
+    free(events);
+}
+
+- (void)dispatchViewControllerLoadView:(UIViewController *)controller {
+    [self dispatchEventWithType:GrowingULLifecycleEventTypeViewControllerLoadView controller:controller];
+}
+
+- (void)dispatchViewControllerDidLoad:(UIViewController *)controller {
+    [self dispatchEventWithType:GrowingULLifecycleEventTypeViewControllerDidLoad controller:controller];
+}
+
+- (void)dispatchViewControllerWillAppear:(UIViewController *)controller {
+    [self dispatchEventWithType:GrowingULLifecycleEventTypeViewControllerWillAppear controller:controller];
+}
+
+- (void)dispatchViewControllerIsAppearing:(UIViewController *)controller {
+    [self dispatchEventWithType:GrowingULLifecycleEventTypeViewControllerIsAppearing controller:controller];
 }
 
 - (void)dispatchViewControllerDidAppear:(UIViewController *)controller {
-    if (controller == nil) {
-        return;
-    }
-    [self.delegateLock lock];
-    for (id delegate in self.lifecycleDelegates) {
-        if ([delegate respondsToSelector:@selector(viewControllerDidAppear:)]) {
-            [delegate viewControllerDidAppear:controller];
-        }
-    }
-    [self.delegateLock unlock];
+    [self dispatchEventWithType:GrowingULLifecycleEventTypeViewControllerDidAppear controller:controller];
 }
 
 - (void)dispatchViewControllerWillDisappear:(UIViewController *)controller {
+    [self dispatchEventWithType:GrowingULLifecycleEventTypeViewControllerWillDisappear controller:controller];
+}
+
+- (void)dispatchViewControllerDidDisappear:(UIViewController *)controller {
+    [self dispatchEventWithType:GrowingULLifecycleEventTypeViewControllerDidDisappear controller:controller];
+}
+
+- (void)dispatchEventWithType:(GrowingULLifecycleEventType)type controller:(UIViewController *)controller {
     if (controller == nil) {
         return;
     }
-
-    [self.delegateLock lock];
-    for (id delegate in self.lifecycleDelegates) {
-        if ([delegate respondsToSelector:@selector(viewControllerWillDisappear:)]) {
-            [delegate viewControllerWillDisappear:controller];
+    GrowingULPageRenderTiming timing;
+    BOOL measured = [self.pageStateTable recordEvent:type forController:controller timing:&timing];
+    GrowingULStallMonitor *stallMonitor = self.stallMonitor;
+    if (type == GrowingULLifecycleEventTypeViewControllerDidAppear ||
+        type == GrowingULLifecycleEventTypeViewControllerDidDisappear) {
+        GrowingULInvalidateTopViewControllerCache();
+        if (type == GrowingULLifecycleEventTypeViewControllerDidAppear) {
+            GrowingULLaunchTimelineRecordPageAppearance([GrowingULTimeUtil currentSystemTimeMillis]);
+        }
+    }
+    GrowingULEventJournal *journal = self.eventJournal;
+    if (journal || stallMonitor) {
+        GrowingULLifecycleEvent event =
+            GrowingULViewControllerEventMake(type, controller, [GrowingULTimeUtil currentSystemTimeMillis]);
+        [journal appendEvent:&event];
+        // the content controller that appeared last is the page -growingul_topViewController would find, without
+        // walking the hierarchy on every appearance; the containers it looks through are skipped the same way
+        if (stallMonitor && type == GrowingULLifecycleEventTypeViewControllerDidAppear &&
+            ![controller isKindOfClass:[UINavigationController class]] &&
+            ![controller isKindOfClass:[UITabBarController class]]) {
+            [stallMonitor setPageClassId:event.classId];
         }
+        [stallMonitor recordEvent:&event];
     }
-    [self.delegateLock unlock];
+    if (atomic_load_explicit(&_bufferingEarlyEvents, memory_order_relaxed) && NSThread.isMainThread) {
+        GrowingULEarlyPageEvent *event = [[GrowingULEarlyPageEvent alloc] init];
+        event.type = type;
+        event.controller = controller;
+        event.timestamp = [GrowingULTimeUtil currentSystemTimeMillis];
+        event.measured = measured;
+        if (measured) {
+            event.timing = timing;
+        }
+        [_earlyEvents addObject:event];
+        return;
+    }
+    [self deliverEventWithType:type controller:controller timing:measured ? &timing : NULL timestamp:0];
 }
 
-- (void)dispatchViewControllerDidDisappear:(UIViewController *)controller {
-    if (controller == nil) {
+- (void)deliverEventWithType:(GrowingULLifecycleEventType)type
+                  controller:(UIViewController *)controller
+                      timing:(const GrowingULPageRenderTiming *)timing
+                   timestamp:(double)timestamp {
+    uint64_t audience = [self.delegateRegistry audienceForClass:object_getClass(controller)];
+    if (audience == 0) {
         return;
     }
-
-    [self.delegateLock lock];
-    for (id delegate in self.lifecycleDelegates) {
-        if ([delegate respondsToSelector:@selector(viewControllerDidDisappear:)]) {
-            [delegate viewControllerDidDisappear:controller];
-        }
+    [self.delegateRegistry dispatchSelectorAtIndex:GrowingULViewControllerCallbackForEventType(type)
+                                        withObject:controller
+                                          audience:audience];
+    if (timing) {
+        [self.delegateRegistry dispatchSelectorAtIndex:GrowingULViewControllerCallbackDidRender
+                                           withPointer:timing
+                                              audience:audience];
     }
-    [self.delegateLock unlock];
+    [self postEventWithType:type controller:controller timestamp:timestamp];
 }
 
 @end
@@ -0,0 +1,258 @@
+//
+//  GrowingULPageStateTable.m
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingTargetConditionals.h"
+
+#if Growing_USE_UIKIT
+#import "GrowingULPageStateTable.h"
+#import "GrowingULPointerMap.h"
+#import "GrowingULTimeUtil.h"
+#import <objc/runtime.h>
+#import <os/lock.h>
+
+static const void *GrowingULPageStateSentinelKey = &GrowingULPageStateSentinelKey;
+
+@interface GrowingULPageStateTable ()
+
+- (void)removeStateForKey:(const void *)key;
+
+@end
+
+// Associated once per controller; removes the table entry while the controller is torn down,
+// before its address can be reused.
+@interface GrowingULPageStateSentinel : NSObject
+
+@property (nonatomic, assign) const void *key;
+
+@end
+
+@implementation GrowingULPageStateSentinel
+
+- (void)dealloc {
+    [[GrowingULPageStateTable sharedTable] removeStateForKey:_key];
+}
+
+@end
+
+// one histogram per interval of GrowingULPageRenderTiming
+typedef struct {
+    GrowingULLatencyHistogram *loadViewToDidLoad;
+    GrowingULLatencyHistogram *didLoadToWillAppear;
+    GrowingULLatencyHistogram *willAppearToDidAppear;
+} GrowingULPageRenderHistograms;
+
+@implementation GrowingULPageStateTable {
+    os_unfair_lock _lock;
+    GrowingULPointerMap *_states;
+    // controller class -> GrowingULPageRenderHistograms, never shrinks
+    GrowingULPointerMap *_renderHistograms;
+}
+
++ (instancetype)sharedTable {
+    static id _sharedTable = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _sharedTable = [[self alloc] init];
+    });
+
+    return _sharedTable;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _states = GrowingULPointerMapCreate(sizeof(GrowingULPageState));
+        _renderHistograms = GrowingULPointerMapCreate(sizeof(GrowingULPageRenderHistograms));
+    }
+
+    return self;
+}
+
+- (void)dealloc {
+    GrowingULPointerMapDestroy(_states);
+    GrowingULPointerMapEnumerate(_renderHistograms, ^(const void *key, void *value, BOOL *stop) {
+        GrowingULPageRenderHistograms *histograms = value;
+        GrowingULLatencyHistogramDestroy(histograms->loadViewToDidLoad);
+        GrowingULLatencyHistogramDestroy(histograms->didLoadToWillAppear);
+        GrowingULLatencyHistogramDestroy(histograms->willAppearToDidAppear);
+    });
+    GrowingULPointerMapDestroy(_renderHistograms);
+}
+
+- (BOOL)getState:(GrowingULPageState *)state forController:(UIViewController *)controller {
+    os_unfair_lock_lock(&_lock);
+    GrowingULPageState *stored = GrowingULPointerMapGet(_states, (__bridge const void *)controller);
+    if (stored) {
+        *state = *stored;
+    } else {
+        memset(state, 0, sizeof(GrowingULPageState));
+    }
+    os_unfair_lock_unlock(&_lock);
+    return stored != NULL;
+}
+
+- (BOOL)recordEvent:(GrowingULLifecycleEventType)event
+      forController:(UIViewController *)controller
+             timing:(GrowingULPageRenderTiming *)timing {
+    uint64_t now = GrowingULMonotonicTimeNanos();
+    BOOL inserted = NO;
+    BOOL measured = NO;
+    GrowingULPageRenderTiming result = {0};
+    GrowingULPageRenderHistograms histograms = {0};
+    os_unfair_lock_lock(&_lock);
+    GrowingULPageState *state = GrowingULPointerMapGetOrInsert(_states, (__bridge const void *)controller, &inserted);
+    state->lastEvent = event;
+    switch (event) {
+        case GrowingULLifecycleEventTypeViewControllerLoadView:
+            state->loadViewTime = now;
+            break;
+        case GrowingULLifecycleEventTypeViewControllerDidLoad:
+            state->didLoadTime = now;
+            break;
+        case GrowingULLifecycleEventTypeViewControllerWillAppear:
+            state->willAppearTime = now;
+            break;
+        case GrowingULLifecycleEventTypeViewControllerDidAppear:
+            if (state->willAppearTime != 0) {
+                measured = YES;
+                result.firstAppearance = state->appearCount == 0;
+                result.willAppearToDidAppearNanos = now - state->willAppearTime;
+                if (result.firstAppearance && state->didLoadTime != 0) {
+                    if (state->loadViewTime != 0) {
+                        result.loadViewToDidLoadNanos = state->didLoadTime - state->loadViewTime;
+                    }
+                    result.didLoadToWillAppearNanos = state->willAppearTime - state->didLoadTime;
+                }
+                state->willAppearTime = 0;
+            }
+            state->didAppear = YES;
+            state->appearCount++;
+            if (state->firstAppearTime == 0) {
+                state->firstAppearTime = [GrowingULTimeUtil currentSystemTimeMillis];
+            }
+            break;
+        case GrowingULLifecycleEventTypeViewControllerDidDisappear:
+            // an appearance cancelled before viewDidAppear: (e.g. an interactive pop) is not measured
+            state->willAppearTime = 0;
+            break;
+        default:
+            break;
+    }
+    if (measured) {
+        histograms = [self renderHistogramsForClassLocked:object_getClass(controller)];
+    }
+    os_unfair_lock_unlock(&_lock);
+
+    if (inserted) {
+        [self attachSentinelToController:controller];
+    }
+    if (!measured) {
+        return NO;
+    }
+
+    if (result.loadViewToDidLoadNanos) {
+        GrowingULLatencyHistogramRecord(histograms.loadViewToDidLoad, result.loadViewToDidLoadNanos);
+    }
+    if (result.didLoadToWillAppearNanos) {
+        GrowingULLatencyHistogramRecord(histograms.didLoadToWillAppear, result.didLoadToWillAppearNanos);
+    }
+    GrowingULLatencyHistogramRecord(histograms.willAppearToDidAppear, result.willAppearToDidAppearNanos);
+    if (timing) {
+        result.controllerClass = object_getClass(controller);
+        result.controllerIdentity = (__bridge const void *)controller;
+        *timing = result;
+    }
+    return YES;
+}
+
+- (GrowingULPageRenderHistograms)renderHistogramsForClassLocked:(Class)controllerClass {
+    BOOL inserted = NO;
+    GrowingULPageRenderHistograms *histograms =
+        GrowingULPointerMapGetOrInsert(_renderHistograms, (__bridge const void *)controllerClass, &inserted);
+    if (inserted) {
+        histograms->loadViewToDidLoad = GrowingULLatencyHistogramCreate();
+        histograms->didLoadToWillAppear = GrowingULLatencyHistogramCreate();
+        histograms->willAppearToDidAppear = GrowingULLatencyHistogramCreate();
+    }
+    return *histograms;
+}
+
+static GrowingULPageRenderStatistics GrowingULPageRenderStatisticsMake(const GrowingULPageRenderHistograms *histograms) {
+    GrowingULPageRenderStatistics statistics;
+    statistics.loadViewToDidLoad = GrowingULLatencyHistogramSummarize(histograms->loadViewToDidLoad);
+    statistics.didLoadToWillAppear = GrowingULLatencyHistogramSummarize(histograms->didLoadToWillAppear);
+    statistics.willAppearToDidAppear = GrowingULLatencyHistogramSummarize(histograms->willAppearToDidAppear);
+    return statistics;
+}
+
+- (GrowingULPageRenderStatistics)renderStatisticsForControllerClass:(Class)controllerClass {
+    GrowingULPageRenderStatistics statistics = {0};
+    os_unfair_lock_lock(&_lock);
+    GrowingULPageRenderHistograms *histograms =
+        GrowingULPointerMapGet(_renderHistograms, (__bridge const void *)controllerClass);
+    GrowingULPageRenderHistograms copy = histograms ? *histograms : (GrowingULPageRenderHistograms){0};
+    os_unfair_lock_unlock(&_lock);
+    // histograms are never freed while the table lives and are safe to read unlocked
+    if (histograms) {
+        statistics = GrowingULPageRenderStatisticsMake(&copy);
+    }
+    return statistics;
+}
+
+- (void)enumerateRenderStatisticsUsingBlock:(void (NS_NOESCAPE ^)(Class controllerClass,
+                                                                  GrowingULPageRenderStatistics statistics))block {
+    NSMutableArray<Class> *classes = [NSMutableArray array];
+    os_unfair_lock_lock(&_lock);
+    GrowingULPointerMapEnumerate(_renderHistograms, ^(const void *key, void *value, BOOL *stop) {
+        [classes addObject:(__bridge Class)key];
+    });
+    os_unfair_lock_unlock(&_lock);
+    for (Class controllerClass in classes) {
+        block(controllerClass, [self renderStatisticsForControllerClass:controllerClass]);
+    }
+}
+
+- (void)setDidAppear:(BOOL)didAppear forController:(UIViewController *)controller {
+    BOOL inserted = NO;
+    os_unfair_lock_lock(&_lock);
+    GrowingULPageState *state = GrowingULPointerMapGetOrInsert(_states, (__bridge const void *)controller, &inserted);
+    state->didAppear = didAppear;
+    os_unfair_lock_unlock(&_lock);
+
+    if (inserted) {
+        [self attachSentinelToController:controller];
+    }
+}
+
+- (void)attachSentinelToController:(UIViewController *)controller {
+    // paid once per controller, outside of the hot path
+    GrowingULPageStateSentinel *sentinel = [[GrowingULPageStateSentinel alloc] init];
+    sentinel.key = (__bridge const void *)controller;
+    objc_setAssociatedObject(controller, GrowingULPageStateSentinelKey, sentinel, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+}
+
+- (void)removeStateForKey:(const void *)key {
+    os_unfair_lock_lock(&_lock);
+    GrowingULPointerMapRemove(_states, key);
+    os_unfair_lock_unlock(&_lock);
+}
+
+@end
+#endif
@@ -0,0 +1,95 @@
+//
+//  GrowingULPageStateTable.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingTargetConditionals.h"
+#import "GrowingULLifecycleEvent.h"
+#import "GrowingULLatencyHistogram.h"
+
+#if Growing_USE_UIKIT
+NS_ASSUME_NONNULL_BEGIN
+
+/// Lifecycle state of one view controller instance.
+typedef struct {
+    BOOL didAppear;
+    /// number of viewDidAppear: calls
+    uint32_t appearCount;
+    /// last lifecycle event seen for the controller
+    GrowingULLifecycleEventType lastEvent;
+    /// +[GrowingULTimeUtil currentSystemTimeMillis] of the first viewDidAppear:, 0 before that
+    double firstAppearTime;
+    /// GrowingULMonotonicTimeNanos() when the callbacks returned, 0 if not seen (willAppear: of the pending appearance)
+    uint64_t loadViewTime;
+    uint64_t didLoadTime;
+    uint64_t willAppearTime;
+} GrowingULPageState;
+
+/// Render intervals of one appearance of a controller, measured between the returns of the lifecycle callbacks.
+typedef struct {
+    __unsafe_unretained Class controllerClass;
+    /// address of the controller, for identity only
+    const void *controllerIdentity;
+    /// YES for the first appearance; the load intervals are only measured for it
+    BOOL firstAppearance;
+    /// loadView -> viewDidLoad, 0 if not measured
+    uint64_t loadViewToDidLoadNanos;
+    /// viewDidLoad -> viewWillAppear:, 0 if not measured
+    uint64_t didLoadToWillAppearNanos;
+    /// viewWillAppear: -> viewDidAppear:, the time to visible of this appearance
+    uint64_t willAppearToDidAppearNanos;
+} GrowingULPageRenderTiming;
+
+/// Render timings aggregated over all instances of a controller class.
+typedef struct {
+    GrowingULLatencySummary loadViewToDidLoad;
+    GrowingULLatencySummary didLoadToWillAppear;
+    GrowingULLatencySummary willAppearToDidAppear;
+} GrowingULPageRenderStatistics;
+
+/**
+ Per-controller page state, kept in an open-addressing table keyed by the controller's address.
+
+ Lookups and updates take a private os_unfair_lock only, never the runtime's associated-object lock. An entry is
+ removed while its controller deallocates.
+ */
+@interface GrowingULPageStateTable : NSObject
+
++ (instancetype)sharedTable;
+
+/// Copies the state of controller into state; returns NO (and a zeroed state) if nothing was recorded yet.
+- (BOOL)getState:(GrowingULPageState *)state forController:(UIViewController *)controller;
+
+/// Records a lifecycle event, updating appear bookkeeping for viewDidAppear:. Returns YES and fills timing when the
+/// event completes a render measurement (viewDidAppear: after viewWillAppear:); the class aggregates are updated too.
+- (BOOL)recordEvent:(GrowingULLifecycleEventType)event
+      forController:(UIViewController *)controller
+             timing:(nullable GrowingULPageRenderTiming *)timing;
+
+/// Aggregated render timings of controllerClass; all counts are 0 if none completed.
+- (GrowingULPageRenderStatistics)renderStatisticsForControllerClass:(Class)controllerClass;
+
+/// Visits every controller class with at least one completed measurement.
+- (void)enumerateRenderStatisticsUsingBlock:(void (NS_NOESCAPE ^)(Class controllerClass,
+                                                                  GrowingULPageRenderStatistics statistics))block;
+
+- (void)setDidAppear:(BOOL)didAppear forController:(UIViewController *)controller;
+
+@end
+
+NS_ASSUME_NONNULL_END
+#endif
@@ -18,9 +18,17 @@
 //  limitations under the License.
 
 #import "GrowingTargetConditionals.h"
+#import "GrowingULLifecycleEvent.h"
+#import "GrowingULLatencyHistogram.h"
+#import "GrowingULClassFilter.h"
+#import "GrowingULEventJournal.h"
+#import "GrowingULStallMonitor.h"
+#import "GrowingULPageStateTable.h"
 
 #if Growing_USE_UIKIT
-@protocol GrowingULViewControllerLifecycleDelegate <NSObject>
+/// GrowingULClassNameForClass(object_getClass(controller)) gives the page name of a controller from the class table
+/// the hub fills, without allocating.
+@protocol GrowingULViewControllerLifecycleDelegate <GrowingULLifecycleEventDelegate>
 
 @optional
 - (void)viewControllerLoadView:(UIViewController *)controller;
@@ -37,6 +45,10 @@
 
 - (void)viewControllerDidDisappear:(UIViewController *)controller;
 
+/// Called after viewControllerDidAppear: for every appearance that started with viewWillAppear:. timing is only
+/// valid for the duration of the call.
+- (void)viewControllerDidRender:(const GrowingULPageRenderTiming *)timing;
+
 @end
 
 @interface UIViewController (GrowingUtilsAutotrackerCore)
@@ -47,13 +59,68 @@
 
 @interface GrowingULViewControllerLifecycle : NSObject
 
+/// Defaults to GrowingULLifecycleDeliveryModeSynchronous.
+@property (nonatomic, assign) GrowingULLifecycleDeliveryMode deliveryMode;
+/// Events asynchronous delegates missed because they fell behind by more than the delivery ring holds.
+@property (nonatomic, assign, readonly) NSUInteger droppedEventCount;
+
+/// Coalesces events into batches for delegates implementing -lifecycleDidReceiveEvents:count:, which then stop
+/// receiving the per-callback methods. Main thread only.
+@property (nonatomic, assign, getter=isBatchingEnabled) BOOL batchingEnabled;
+
+/// Batch window in seconds; 0 (the default) delivers one batch per main run loop turn.
+@property (nonatomic, assign) NSTimeInterval batchInterval;
+
+/// Drops the events of controllers that start appearing and disappear again without reaching viewDidAppear within
+/// one batch.
+@property (nonatomic, assign) BOOL foldsTransientAppearances;
+/// Times every delegate callback; see -delegateLatencySnapshot. Off by default.
+@property (nonatomic, assign, getter=isLatencyInstrumentationEnabled) BOOL latencyInstrumentationEnabled;
+
+/// Receives every event observed, whether or not a delegate is interested in it. Set it before setup.
+@property (nonatomic, strong) GrowingULEventJournal *eventJournal;
+
+/// Told about every event observed, and about the page whenever a controller other than a navigation or tab bar
+/// controller appears, so that its stalls name the page and the last event.
+@property (nonatomic, strong) GrowingULStallMonitor *stallMonitor;
+
+/// Mode of the first setup call.
+@property (nonatomic, assign, readonly) GrowingULSetupMode setupMode;
+/// GrowingULMonotonicTimeNanos() spent in the first setup call, that is on the caller's launch path.
+@property (nonatomic, assign, readonly) uint64_t setupNanos;
+/// Time spent completing a staged setup on the first idle run loop pass, replay included; 0 for immediate setups.
+@property (nonatomic, assign, readonly) uint64_t deferredSetupNanos;
+/// +[GrowingULTimeUtil currentSystemTimeMillis] when every hook was installed, 0 before.
+@property (nonatomic, assign, readonly) double setupCompletedTime;
+
 + (instancetype)sharedInstance;
 
+/// Same as +setupWithMode:GrowingULSetupModeImmediate.
 + (void)setup;
 
+/// A staged setup only hooks viewWillAppear: and viewDidAppear: before returning, so the first appearances are
+/// recorded; the other callbacks are hooked on the first idle run loop pass. loadView and viewDidLoad of the
+/// controllers loaded before that are not seen, and their first render timing has no load intervals.
++ (void)setupWithMode:(GrowingULSetupMode)mode;
+
+/// Delegates are held weakly and may remove themselves from -dealloc.
 - (void)addViewControllerLifecycleDelegate:(id<GrowingULViewControllerLifecycleDelegate>)delegate;
 
+/// The delegate is only called for controllers whose class filter accepts, on every delivery route. Events of
+/// controllers no delegate accepts are not dispatched at all.
+- (void)addViewControllerLifecycleDelegate:(id<GrowingULViewControllerLifecycleDelegate>)delegate
+                               classFilter:(GrowingULClassFilter *)filter;
+
 - (void)removeViewControllerLifecycleDelegate:(id<GrowingULViewControllerLifecycleDelegate>)delegate;
 
+/// Per delegate class and callback latency recorded while latencyInstrumentationEnabled was YES.
+- (NSArray<GrowingULDelegateLatency *> *)delegateLatencySnapshot;
+
+/// Render timings aggregated per controller class, see -viewControllerDidRender:.
+- (GrowingULPageRenderStatistics)renderStatisticsForControllerClass:(Class)controllerClass;
+
+- (void)enumerateRenderStatisticsUsingBlock:(void (NS_NOESCAPE ^)(Class controllerClass,
+                                                                  GrowingULPageRenderStatistics statistics))block;
+
 @end
 #endif
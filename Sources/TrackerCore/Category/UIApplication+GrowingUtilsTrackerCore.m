@@ -23,10 +23,94 @@
 #import "UIApplication+GrowingUtilsTrackerCore.h"
 #import "UIViewController+GrowingUtilsTrackerCore.h"
 #import "GrowingULApplication.h"
+#import "GrowingULSwizzleHook.h"
+
+// main thread only
+static BOOL growingul_keyWindowCached = NO;
+static __weak UIWindow *growingul_cachedKeyWindow = nil;
+static BOOL growingul_topViewControllerCacheEnabled = NO;
+static BOOL growingul_topViewControllerCached = NO;
+// GrowingULSwizzleHooksActive() generation the cached controller was walked at
+static uint64_t growingul_topViewControllerGeneration = 0;
+static __weak UIViewController *growingul_cachedTopViewController = nil;
+static BOOL growingul_lookupCacheVerification = NO;
+static NSUInteger growingul_lookupCacheMismatches = 0;
+
+void GrowingULInvalidateTopViewControllerCache(void) {
+    growingul_topViewControllerCached = NO;
+}
+
+static void GrowingULInvalidateKeyWindowCache(void) {
+    growingul_keyWindowCached = NO;
+    growingul_topViewControllerCached = NO;
+}
+
+void GrowingULEnableTopViewControllerCache(void) {
+    growingul_topViewControllerCacheEnabled = YES;
+    GrowingULInvalidateTopViewControllerCache();
+}
+
+void GrowingULSetLookupCacheVerificationEnabled(BOOL enabled) {
+    growingul_lookupCacheVerification = enabled;
+}
+
+NSUInteger GrowingULLookupCacheMismatchCount(void) {
+    return growingul_lookupCacheMismatches;
+}
+
+static void GrowingULObserveKeyWindowChanges(void) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSMutableArray<NSNotificationName> *names = [NSMutableArray arrayWithObjects:UIWindowDidBecomeKeyNotification,
+                                                                                     UIWindowDidResignKeyNotification,
+                                                                                     UIWindowDidBecomeVisibleNotification,
+                                                                                     UIWindowDidBecomeHiddenNotification,
+                                                                                     nil];
+#if Growing_OS_VISION
+        if (1) { // if (@available(visionOS 1.0, *)) {
+#else
+        if (@available(iOS 13.0, macCatalyst 13.1, tvOS 13.0, *)) {
+#endif
+            [names addObjectsFromArray:@[UISceneDidActivateNotification,
+                                         UISceneWillDeactivateNotification,
+                                         UISceneDidDisconnectNotification]];
+        }
+        for (NSNotificationName name in names) {
+            [[NSNotificationCenter defaultCenter] addObserverForName:name
+                                                              object:nil
+                                                               queue:nil
+                                                          usingBlock:^(NSNotification *notification) {
+                                                              GrowingULInvalidateKeyWindowCache();
+                                                          }];
+        }
+    });
+}
 
 @implementation UIApplication (GrowingUtilsTrackerCore)
 
 - (nullable UIWindow *)growingul_keyWindow {
+    if (!NSThread.isMainThread) {
+        return [self growingul_findKeyWindow];
+    }
+    GrowingULObserveKeyWindowChanges();
+    if (!growingul_keyWindowCached) {
+        growingul_cachedKeyWindow = [self growingul_findKeyWindow];
+        growingul_keyWindowCached = YES;
+        return growingul_cachedKeyWindow;
+    }
+    UIWindow *keyWindow = growingul_cachedKeyWindow;
+    if (growingul_lookupCacheVerification) {
+        UIWindow *walked = [self growingul_findKeyWindow];
+        if (walked != keyWindow) {
+            growingul_lookupCacheMismatches++;
+            growingul_cachedKeyWindow = walked;
+            keyWindow = walked;
+        }
+    }
+    return keyWindow;
+}
+
+- (nullable UIWindow *)growingul_findKeyWindow {
     if ([GrowingULApplication isAppExtension]) {
         return nil;
     }
@@ -65,6 +149,31 @@
 }
 
 - (nullable UIViewController *)growingul_topViewController {
+    uint64_t generation = 0;
+    // appearances are missed while the hooks that invalidate the cache are suspended
+    if (!growingul_topViewControllerCacheEnabled || !NSThread.isMainThread ||
+        !GrowingULSwizzleHooksActive(&generation)) {
+        return [self growingul_findTopViewController];
+    }
+    if (!growingul_topViewControllerCached || generation != growingul_topViewControllerGeneration) {
+        growingul_cachedTopViewController = [self growingul_findTopViewController];
+        growingul_topViewControllerCached = YES;
+        growingul_topViewControllerGeneration = generation;
+        return growingul_cachedTopViewController;
+    }
+    UIViewController *topViewController = growingul_cachedTopViewController;
+    if (growingul_lookupCacheVerification) {
+        UIViewController *walked = [self growingul_findTopViewController];
+        if (walked != topViewController) {
+            growingul_lookupCacheMismatches++;
+            growingul_cachedTopViewController = walked;
+            topViewController = walked;
+        }
+    }
+    return topViewController;
+}
+
+- (nullable UIViewController *)growingul_findTopViewController {
     UIWindow *keyWindow = self.growingul_keyWindow;
     if (!keyWindow) {
         return nil;
@@ -77,6 +186,14 @@
 }
 
 - (CGFloat)growingul_statusBarHeight {
+    GrowingULEnvironment environment = GrowingULCurrentEnvironment();
+    if (environment.hasGeometry) {
+        return environment.statusBarHeight;
+    }
+    return [self growingul_currentStatusBarHeight];
+}
+
+- (CGFloat)growingul_currentStatusBarHeight {
     CGFloat statusBarHeight = 0.0f;
 #if Growing_OS_IOS || Growing_OS_MACCATALYST
     if (@available(iOS 13.0, macCatalyst 13.1, *)) {
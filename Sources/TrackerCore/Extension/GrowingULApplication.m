@@ -19,34 +19,175 @@
 
 #import "GrowingULApplication.h"
 
-@implementation GrowingULApplication
+#import <os/lock.h>
+#import <stdatomic.h>
 
-+ (nullable id)sharedApplication {
+// Written under growingul_environmentLock and a sequence counter; readers retry while it is odd or changes.
+static GrowingULEnvironment growingul_environment;
+static atomic_uint growingul_environmentSequence;
+static os_unfair_lock growingul_environmentLock = OS_UNFAIR_LOCK_INIT;
+
+static void GrowingULPublishEnvironment(const GrowingULEnvironment *environment) {
+    atomic_fetch_add_explicit(&growingul_environmentSequence, 1, memory_order_acq_rel);
+    atomic_thread_fence(memory_order_release);
+    growingul_environment = *environment;
+    atomic_fetch_add_explicit(&growingul_environmentSequence, 1, memory_order_release);
+}
+
+static GrowingULEnvironment GrowingULReadEnvironment(void) {
+    GrowingULEnvironment environment;
+    unsigned begin, end;
+    do {
+        begin = atomic_load_explicit(&growingul_environmentSequence, memory_order_acquire);
+        environment = growingul_environment;
+        atomic_thread_fence(memory_order_acquire);
+        end = atomic_load_explicit(&growingul_environmentSequence, memory_order_relaxed);
+    } while ((begin & 1) || begin != end);
+    return environment;
+}
+
+static id GrowingULSharedApplication(Class applicationClass) {
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Warc-performSelector-leaks"
+    return [applicationClass performSelector:NSSelectorFromString(@"sharedApplication")];
+#pragma clang diagnostic pop
+}
+
+static void GrowingULResolveApplication(GrowingULEnvironment *environment) {
     Class class;
 #if Growing_USE_APPKIT
     class = NSClassFromString(@"NSApplication");
+    environment->framework = GrowingULUIFrameworkAppKit;
 #elif Growing_USE_UIKIT
     class = NSClassFromString(@"UIApplication");
+    environment->framework = GrowingULUIFrameworkUIKit;
 #elif Growing_USE_WATCHKIT
     class = NSClassFromString(@"WKApplication");
+    environment->framework = GrowingULUIFrameworkWatchKit;
 #endif
-    
-    SEL selector = NSSelectorFromString(@"sharedApplication");
-    if(!class || ![class respondsToSelector:selector]) {
-        return nil;
+
+    if (class && [class respondsToSelector:NSSelectorFromString(@"sharedApplication")]) {
+        environment->applicationClass = class;
+        environment->application = GrowingULSharedApplication(class);
     }
-    return [class performSelector:selector];
-#pragma clang diagnostic pop
-}
 
-+ (BOOL)isAppExtension {
 #if Growing_OS_IOS || Growing_OS_TV || Growing_OS_WATCH
-    return [[[NSBundle mainBundle] bundlePath] hasSuffix:@".appex"];
-#else
-    return NO;
+    environment->isAppExtension = [[[NSBundle mainBundle] bundlePath] hasSuffix:@".appex"];
 #endif
+
+#if Growing_USE_UIKIT
+    environment->hasSceneManifest = [[NSBundle mainBundle] infoDictionary][@"UIApplicationSceneManifest"] != nil;
+    environment->usesSceneLifecycle =
+        environment->hasSceneManifest && UIDevice.currentDevice.systemVersion.doubleValue >= 13.0;
+#endif
+}
+
+// main thread only
+static void GrowingULReadGeometry(GrowingULEnvironment *environment) {
+#if Growing_USE_UIKIT
+    UIApplication *application = environment->application;
+    if (application && !environment->isAppExtension) {
+        environment->statusBarHeight = [application growingul_currentStatusBarHeight];
+    }
+#if Growing_OS_IOS || Growing_OS_TV
+    UIScreen *screen = UIScreen.mainScreen;
+    environment->screenSize = screen.bounds.size;
+    environment->screenScale = screen.scale;
+#endif
+#endif
+    environment->hasGeometry = YES;
+}
+
+static void GrowingULRefreshGeometry(void) {
+    // read outside of the lock, UIKit may call back into code that reads the environment
+    GrowingULEnvironment geometry = GrowingULCurrentEnvironment();
+    GrowingULReadGeometry(&geometry);
+    os_unfair_lock_lock(&growingul_environmentLock);
+    GrowingULEnvironment environment = GrowingULReadEnvironment();
+    environment.hasGeometry = geometry.hasGeometry;
+    environment.statusBarHeight = geometry.statusBarHeight;
+    environment.screenSize = geometry.screenSize;
+    environment.screenScale = geometry.screenScale;
+    GrowingULPublishEnvironment(&environment);
+    os_unfair_lock_unlock(&growingul_environmentLock);
+}
+
+static void GrowingULBuildEnvironmentOnce(void) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        GrowingULEnvironment environment = {0};
+        GrowingULResolveApplication(&environment);
+        os_unfair_lock_lock(&growingul_environmentLock);
+        GrowingULPublishEnvironment(&environment);
+        os_unfair_lock_unlock(&growingul_environmentLock);
+    });
+}
+
+// +sharedApplication is nil until UIApplicationMain creates it; an environment built earlier (from +load or an
+// initializer) asks again on every call until it gets one.
+static void GrowingULResolvePendingApplication(void) {
+    os_unfair_lock_lock(&growingul_environmentLock);
+    GrowingULEnvironment environment = GrowingULReadEnvironment();
+    if (!environment.application) {
+        environment.application = GrowingULSharedApplication(environment.applicationClass);
+        if (environment.application) {
+            GrowingULPublishEnvironment(&environment);
+        }
+    }
+    os_unfair_lock_unlock(&growingul_environmentLock);
+}
+
+GrowingULEnvironment GrowingULCurrentEnvironment(void) {
+    GrowingULBuildEnvironmentOnce();
+    GrowingULEnvironment environment = GrowingULReadEnvironment();
+    if (__builtin_expect(!environment.application && environment.applicationClass && !environment.isAppExtension, 0)) {
+        GrowingULResolvePendingApplication();
+        environment = GrowingULReadEnvironment();
+    }
+    return environment;
+}
+
+@implementation GrowingULApplication
+
++ (void)setup {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        GrowingULBuildEnvironmentOnce();
+#if Growing_USE_UIKIT
+        NSMutableArray<NSNotificationName> *names = [NSMutableArray arrayWithObjects:UIWindowDidBecomeKeyNotification,
+                                                                                     UIScreenModeDidChangeNotification,
+                                                                                     nil];
+#if Growing_OS_IOS
+        [names addObject:UIDeviceOrientationDidChangeNotification];
+        [names addObject:UIApplicationDidChangeStatusBarFrameNotification];
+#endif
+        // notification name use NSString, see -[GrowingULAppLifecycle getNotificationRoutes:]
+        [names addObject:@"UISceneDidActivateNotification"];
+        for (NSNotificationName name in names) {
+            [[NSNotificationCenter defaultCenter] addObserverForName:name
+                                                              object:nil
+                                                               queue:[NSOperationQueue mainQueue]
+                                                          usingBlock:^(NSNotification *notification) {
+                                                              GrowingULRefreshGeometry();
+                                                          }];
+        }
+        if (NSThread.isMainThread) {
+            GrowingULRefreshGeometry();
+        } else {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                GrowingULRefreshGeometry();
+            });
+        }
+#endif
+    });
+}
+
++ (nullable id)sharedApplication {
+    return GrowingULCurrentEnvironment().application;
+}
+
++ (BOOL)isAppExtension {
+    return GrowingULCurrentEnvironment().isAppExtension;
 }
 
 @end
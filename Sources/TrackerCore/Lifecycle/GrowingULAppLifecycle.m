@@ -20,21 +20,67 @@
 #import "GrowingULApplication.h"
 #import "GrowingULAppLifecycle.h"
 #import "GrowingULTimeUtil.h"
+#import "GrowingULDelegateRegistry.h"
+#import "GrowingULLaunchTimeline.h"
+#import "GrowingULRunLoopIdle.h"
+#import "GrowingULSceneStateAggregator.h"
+#import <stdatomic.h>
+
+typedef NS_ENUM(NSUInteger, GrowingULAppCallback) {
+    GrowingULAppCallbackDidFinishLaunching = 0,
+    GrowingULAppCallbackWillTerminate,
+    GrowingULAppCallbackDidBecomeActive,
+    GrowingULAppCallbackWillResignActive,
+    GrowingULAppCallbackDidEnterBackground,
+    GrowingULAppCallbackWillEnterForeground,
+    GrowingULAppCallbackDidCompleteLaunch,
+    GrowingULAppCallbackSceneDidTransition,
+    GrowingULAppCallbackCount
+};
+
+// An observed notification and the handler it is delivered to.
+typedef struct {
+    __unsafe_unretained NSString *name;
+    SEL handler;
+    // observed on the application object, with object nil otherwise
+    BOOL postedByApplication;
+} GrowingULNotificationRoute;
+
+#define GrowingULNotificationRouteMaxCount 8
 
 @interface GrowingULAppLifecycle ()
 
-@property (strong, nonatomic, readonly) NSPointerArray *lifecycleDelegates;
-@property (strong, nonatomic, readonly) NSLock *delegateLock;
+@property (strong, nonatomic, readonly) GrowingULDelegateRegistry *delegateRegistry;
 
 @end
 
-@implementation GrowingULAppLifecycle
+@implementation GrowingULAppLifecycle {
+    atomic_bool _setupCompleted;
+    // main thread only; notifications seen while a staged setup is pending, with their capture times
+    NSMutableArray<NSNotification *> *_earlyNotifications;
+    NSMutableArray<NSNumber *> *_earlyNotificationTimes;
+    // main thread only; capture time of the event being replayed, 0 otherwise
+    double _replayTime;
+    // main thread only
+    GrowingULSceneStateAggregator *_sceneStates;
+}
 
 - (instancetype)init {
     self = [super init];
     if (self) {
-        _lifecycleDelegates = [NSPointerArray pointerArrayWithOptions:NSPointerFunctionsWeakMemory];
-        _delegateLock = [[NSLock alloc] init];
+        SEL selectors[GrowingULAppCallbackCount] = {
+            [GrowingULAppCallbackDidFinishLaunching] = @selector(applicationDidFinishLaunching:),
+            [GrowingULAppCallbackWillTerminate] = @selector(applicationWillTerminate),
+            [GrowingULAppCallbackDidBecomeActive] = @selector(applicationDidBecomeActive),
+            [GrowingULAppCallbackWillResignActive] = @selector(applicationWillResignActive),
+            [GrowingULAppCallbackDidEnterBackground] = @selector(applicationDidEnterBackground),
+            [GrowingULAppCallbackWillEnterForeground] = @selector(applicationWillEnterForeground),
+            [GrowingULAppCallbackDidCompleteLaunch] = @selector(applicationDidCompleteLaunch:),
+            [GrowingULAppCallbackSceneDidTransition] = @selector(applicationSceneDidTransition:),
+        };
+        _delegateRegistry = [[GrowingULDelegateRegistry alloc] initWithSelectors:selectors
+                                                                           count:GrowingULAppCallbackCount];
+        _sceneStates = [[GrowingULSceneStateAggregator alloc] init];
     }
 
     return self;
@@ -51,264 +97,459 @@
 }
 
 + (void)setup {
+    [self setupWithMode:GrowingULSetupModeImmediate];
+}
+
++ (void)setupWithMode:(GrowingULSetupMode)mode {
+    NSAssert(mode != GrowingULSetupModeStaged || NSThread.isMainThread, @"staged setup must run on the main thread");
+    if (!NSThread.isMainThread) {
+        mode = GrowingULSetupModeImmediate;
+    }
+    GrowingULAppLifecycle *lifecycle = [self sharedInstance];
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
-        [[self sharedInstance] setupAppStateNotification];
+        uint64_t start = GrowingULMonotonicTimeNanos();
+        lifecycle->_setupMode = mode;
+        if (mode == GrowingULSetupModeStaged) {
+            [lifecycle observeEarlyNotifications];
+            GrowingULPerformWhenMainRunLoopIdle(^{
+                [lifecycle completeSetup];
+            });
+        } else {
+            [lifecycle completeSetup];
+        }
+        lifecycle->_setupNanos = GrowingULMonotonicTimeNanos() - start;
     });
+    if (mode == GrowingULSetupModeImmediate) {
+        // an immediate setup after a staged one does not wait for the run loop; the early buffer is main thread only
+        if (NSThread.isMainThread) {
+            [lifecycle completeSetup];
+        } else {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [lifecycle completeSetup];
+            });
+        }
+    }
 }
 
-- (void)setupAppStateNotification {
-    NSNotificationCenter *nc = [NSNotificationCenter defaultCenter];
+- (void)observeEarlyNotifications {
+    _earlyNotifications = [NSMutableArray array];
+    _earlyNotificationTimes = [NSMutableArray array];
+    // object nil, resolving the application object is part of the deferred work
+    for (NSString *name in [self earlyNotificationNames]) {
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(bufferEarlyNotification:)
+                                                     name:name
+                                                   object:nil];
+    }
+}
 
+- (NSArray<NSString *> *)earlyNotificationNames {
 #if Growing_USE_UIKIT
-    for (NSString *name in @[
+    return @[
         UIApplicationDidFinishLaunchingNotification,
-        UIApplicationWillTerminateNotification]) {
-        [nc addObserver:self
-               selector:@selector(handleProcessLifecycleNotification:)
-                   name:name
-                 object:[GrowingULApplication sharedApplication]];
-    }
-
-    NSDictionary *sceneManifestDict = [[NSBundle mainBundle] infoDictionary][@"UIApplicationSceneManifest"];
-    if (sceneManifestDict && UIDevice.currentDevice.systemVersion.doubleValue >= 13.0) {
-        [self addSceneNotification];
-    } else {
-        for (NSString *name in @[
-            UIApplicationDidBecomeActiveNotification,
-            UIApplicationWillEnterForegroundNotification,
-            UIApplicationWillResignActiveNotification,
-            UIApplicationDidEnterBackgroundNotification]) {
-            [nc addObserver:self
-                   selector:@selector(handleUILifecycleNotification:)
-                       name:name
-                     object:[GrowingULApplication sharedApplication]];
-        }
-    }
+        UIApplicationWillTerminateNotification,
+        UIApplicationDidBecomeActiveNotification,
+        UIApplicationWillEnterForegroundNotification,
+        UIApplicationWillResignActiveNotification,
+        UIApplicationDidEnterBackgroundNotification,
+        @"UISceneWillConnectNotification",
+        @"UISceneWillEnterForegroundNotification",
+        @"UISceneDidActivateNotification",
+        @"UISceneWillDeactivateNotification",
+        @"UISceneDidEnterBackgroundNotification",
+        @"UISceneDidDisconnectNotification",
+    ];
 #elif Growing_USE_APPKIT
-    for (NSString *name in @[
+    return @[
         NSApplicationDidFinishLaunchingNotification,
-        NSApplicationWillTerminateNotification]) {
-        [nc addObserver:self
-               selector:@selector(handleProcessLifecycleNotification:)
-                   name:name
-                 object:[GrowingULApplication sharedApplication]];
-    }
-    
-    for (NSString *name in @[
+        NSApplicationWillTerminateNotification,
         NSApplicationDidBecomeActiveNotification,
-        NSApplicationWillResignActiveNotification]) {
-        [nc addObserver:self
-               selector:@selector(handleUILifecycleNotification:)
-                   name:name
-                 object:[GrowingULApplication sharedApplication]];
-    }
+        NSApplicationWillResignActiveNotification,
+    ];
 #elif Growing_USE_WATCHKIT
-    if (@available (watchOS 7.0, *)) {
-        for (NSString *name in @[
-            WKApplicationDidFinishLaunchingNotification]) {
-            [nc addObserver:self
-                   selector:@selector(handleProcessLifecycleNotification:)
-                       name:name
-                     object:nil];
-        }
-        
-        for (NSString *name in @[
+    if (@available(watchOS 7.0, *)) {
+        return @[
+            WKApplicationDidFinishLaunchingNotification,
             WKApplicationDidBecomeActiveNotification,
             WKApplicationWillEnterForegroundNotification,
             WKApplicationWillResignActiveNotification,
-            WKApplicationDidEnterBackgroundNotification]) {
-            [nc addObserver:self
-                   selector:@selector(handleUILifecycleNotification:)
-                       name:name
-                     object:nil];
-        }
+            WKApplicationDidEnterBackgroundNotification,
+        ];
     }
+    return @[];
+#else
+    return @[];
 #endif
 }
 
+- (void)bufferEarlyNotification:(NSNotification *)notification {
+    [_earlyNotifications addObject:notification];
+    [_earlyNotificationTimes addObject:@([GrowingULTimeUtil currentSystemTimeMillis])];
+    if ([self isTerminateNotification:notification]) {
+        // there will be no idle pass to wait for
+        [self completeSetup];
+    }
+}
+
+- (BOOL)isTerminateNotification:(NSNotification *)notification {
 #if Growing_USE_UIKIT
-- (void)addSceneNotification {
-    if (@available(iOS 13, *)) {
-        NSNotificationCenter *nc = [NSNotificationCenter defaultCenter];
-        // notification name use NSString rather than UISceneWillDeactivateNotification. Xcode 9 package error for no
-        // iOS 13 SDK (use of undeclared identifier 'UISceneDidEnterBackgroundNotification'; did you mean
-        // 'UIApplicationDidEnterBackgroundNotification'?)
-        [nc addObserver:self
-               selector:@selector(dispatchApplicationWillResignActive)
-                   name:@"UISceneWillDeactivateNotification"
-                 object:nil];
+    return [notification.name isEqualToString:UIApplicationWillTerminateNotification];
+#elif Growing_USE_APPKIT
+    return [notification.name isEqualToString:NSApplicationWillTerminateNotification];
+#else
+    return NO;
+#endif
+}
 
-        [nc addObserver:self
-               selector:@selector(dispatchApplicationDidBecomeActive)
-                   name:@"UISceneDidActivateNotification"
-                 object:nil];
+- (void)completeSetup {
+    if (atomic_exchange(&_setupCompleted, true)) {
+        return;
+    }
+    uint64_t start = GrowingULMonotonicTimeNanos();
+    NSArray<NSNotification *> *earlyNotifications = _earlyNotifications;
+    NSArray<NSNumber *> *earlyNotificationTimes = _earlyNotificationTimes;
+    if (earlyNotifications) {
+        // before installing the regular observers, removal by name would take them out too
+        for (NSString *name in [self earlyNotificationNames]) {
+            [[NSNotificationCenter defaultCenter] removeObserver:self name:name object:nil];
+        }
+        _earlyNotifications = nil;
+        _earlyNotificationTimes = nil;
+    }
 
-        [nc addObserver:self
-               selector:@selector(dispatchApplicationWillEnterForeground)
-                   name:@"UISceneWillEnterForegroundNotification"
-                 object:nil];
+    [GrowingULApplication setup];
+    [self setupAppStateNotification];
 
-        [nc addObserver:self
-               selector:@selector(dispatchApplicationDidEnterBackground)
-                   name:@"UISceneDidEnterBackgroundNotification"
-                 object:nil];
+    for (NSUInteger i = 0; i < earlyNotifications.count; i++) {
+        _replayTime = earlyNotificationTimes[i].doubleValue;
+        [self replayEarlyNotification:earlyNotifications[i]];
     }
-}
-#endif
+    _replayTime = 0;
+    // after the replay, which already placed the scenes it saw
+    [self seedSceneStates];
 
-- (void)dealloc {
-    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    if (earlyNotifications) {
+        _deferredSetupNanos = GrowingULMonotonicTimeNanos() - start;
+    }
+    _setupCompletedTime = [GrowingULTimeUtil currentSystemTimeMillis];
 }
 
-- (void)handleProcessLifecycleNotification:(NSNotification *)notification {
-    NSString *name = notification.name;
-
+// Scenes connected before the scene routes were installed, e.g. when set up from a scene delegate, would otherwise
+// not count until their next transition and the application state would read background meanwhile.
+- (void)seedSceneStates {
 #if Growing_USE_UIKIT
-    if ([name isEqualToString:UIApplicationDidFinishLaunchingNotification]) {
-        [self dispatchApplicationDidFinishLaunching:notification.userInfo];
-    } else if ([name isEqualToString:UIApplicationWillTerminateNotification]) {
-        [self dispatchApplicationWillTerminate];
+    if (!GrowingULCurrentEnvironment().usesSceneLifecycle) {
+        return;
     }
-#elif Growing_USE_APPKIT
-    if ([name isEqualToString:NSApplicationDidFinishLaunchingNotification]) {
-        [self dispatchApplicationDidFinishLaunching:notification.userInfo];
-    } else if ([name isEqualToString:NSApplicationWillTerminateNotification]) {
-        [self dispatchApplicationWillTerminate];
-    }
-#elif Growing_USE_WATCHKIT
-    if (@available (watchOS 7.0, *)) {
-        if ([name isEqualToString:WKApplicationDidFinishLaunchingNotification]) {
-            [self dispatchApplicationDidFinishLaunching:notification.userInfo];
+#if Growing_OS_VISION
+    if (1) { // if (@available(visionOS 1.0, *)) {
+#else
+    if (@available(iOS 13.0, macCatalyst 13.1, tvOS 13.0, *)) {
+#endif
+        UIApplication *application = GrowingULCurrentEnvironment().application;
+        for (UIScene *scene in application.connectedScenes) {
+            GrowingULSceneActivationState state;
+            switch (scene.activationState) {
+                case UISceneActivationStateForegroundActive:
+                    state = GrowingULSceneActivationStateForegroundActive;
+                    break;
+                case UISceneActivationStateForegroundInactive:
+                    state = GrowingULSceneActivationStateForegroundInactive;
+                    break;
+                case UISceneActivationStateBackground:
+                    state = GrowingULSceneActivationStateBackground;
+                    break;
+                default:
+                    state = GrowingULSceneActivationStateUnattached;
+                    break;
+            }
+            [_sceneStates seedScene:(__bridge const void *)scene state:state];
         }
     }
 #endif
 }
 
-- (void)handleUILifecycleNotification:(NSNotification *)notification {
-    NSString *name = notification.name;
+// Delivers a buffered notification the way the observers installed by -setupAppStateNotification would have.
+- (void)replayEarlyNotification:(NSNotification *)notification {
+    GrowingULNotificationRoute routes[GrowingULNotificationRouteMaxCount];
+    NSUInteger count = [self getNotificationRoutes:routes];
+    for (NSUInteger i = 0; i < count; i++) {
+        if ([routes[i].name isEqualToString:notification.name]) {
+            void (*handler)(id, SEL, NSNotification *) = (void *)[self methodForSelector:routes[i].handler];
+            handler(self, routes[i].handler, notification);
+            return;
+        }
+    }
+    // notifications of the lifecycle the app does not use (application or scenes) are dropped
+}
+
+- (double)eventTime {
+    return _replayTime > 0 ? _replayTime : [GrowingULTimeUtil currentSystemTimeMillis];
+}
 
+// Fills routes with the notifications of the platform, and of the lifecycle the app uses; returns their count.
+- (NSUInteger)getNotificationRoutes:(GrowingULNotificationRoute *)routes {
+    NSUInteger count = 0;
 #if Growing_USE_UIKIT
-    if ([name isEqualToString:UIApplicationDidBecomeActiveNotification]) {
-        [self dispatchApplicationDidBecomeActive];
-    } else if ([name isEqualToString:UIApplicationWillEnterForegroundNotification]) {
-        [self dispatchApplicationWillEnterForeground];
-    } else if ([name isEqualToString:UIApplicationWillResignActiveNotification]) {
-        [self dispatchApplicationWillResignActive];
-    } else if ([name isEqualToString:UIApplicationDidEnterBackgroundNotification]) {
-        [self dispatchApplicationDidEnterBackground];
+    routes[count++] = (GrowingULNotificationRoute){
+        UIApplicationDidFinishLaunchingNotification, @selector(handleDidFinishLaunching:), YES};
+    routes[count++] =
+        (GrowingULNotificationRoute){UIApplicationWillTerminateNotification, @selector(handleWillTerminate:), YES};
+    if (GrowingULCurrentEnvironment().usesSceneLifecycle) {
+        // notification name use NSString rather than UISceneWillDeactivateNotification. Xcode 9 package error for no
+        // iOS 13 SDK (use of undeclared identifier 'UISceneDidEnterBackgroundNotification'; did you mean
+        // 'UIApplicationDidEnterBackgroundNotification'?)
+        routes[count++] =
+            (GrowingULNotificationRoute){@"UISceneWillConnectNotification", @selector(handleSceneWillConnect:), NO};
+        routes[count++] = (GrowingULNotificationRoute){
+            @"UISceneWillEnterForegroundNotification", @selector(handleSceneWillEnterForeground:), NO};
+        routes[count++] =
+            (GrowingULNotificationRoute){@"UISceneDidActivateNotification", @selector(handleSceneDidActivate:), NO};
+        routes[count++] = (GrowingULNotificationRoute){
+            @"UISceneWillDeactivateNotification", @selector(handleSceneWillDeactivate:), NO};
+        routes[count++] = (GrowingULNotificationRoute){
+            @"UISceneDidEnterBackgroundNotification", @selector(handleSceneDidEnterBackground:), NO};
+        routes[count++] = (GrowingULNotificationRoute){
+            @"UISceneDidDisconnectNotification", @selector(handleSceneDidDisconnect:), NO};
+    } else {
+        routes[count++] = (GrowingULNotificationRoute){
+            UIApplicationDidBecomeActiveNotification, @selector(handleDidBecomeActive:), YES};
+        routes[count++] = (GrowingULNotificationRoute){
+            UIApplicationWillEnterForegroundNotification, @selector(handleWillEnterForeground:), YES};
+        routes[count++] = (GrowingULNotificationRoute){
+            UIApplicationWillResignActiveNotification, @selector(handleWillResignActive:), YES};
+        routes[count++] = (GrowingULNotificationRoute){
+            UIApplicationDidEnterBackgroundNotification, @selector(handleDidEnterBackground:), YES};
     }
 #elif Growing_USE_APPKIT
-    if ([name isEqualToString:NSApplicationDidBecomeActiveNotification]) {
-        [self dispatchApplicationDidBecomeActive];
-    } else if ([name isEqualToString:NSApplicationWillResignActiveNotification]) {
-        [self dispatchApplicationWillResignActive];
-    }
+    routes[count++] = (GrowingULNotificationRoute){
+        NSApplicationDidFinishLaunchingNotification, @selector(handleDidFinishLaunching:), YES};
+    routes[count++] =
+        (GrowingULNotificationRoute){NSApplicationWillTerminateNotification, @selector(handleWillTerminate:), YES};
+    routes[count++] =
+        (GrowingULNotificationRoute){NSApplicationDidBecomeActiveNotification, @selector(handleDidBecomeActive:), YES};
+    routes[count++] = (GrowingULNotificationRoute){
+        NSApplicationWillResignActiveNotification, @selector(handleWillResignActive:), YES};
 #elif Growing_USE_WATCHKIT
-    if (@available (watchOS 7.0, *)) {
-        if ([name isEqualToString:WKApplicationDidBecomeActiveNotification]) {
-            [self dispatchApplicationDidBecomeActive];
-        } else if ([name isEqualToString:WKApplicationWillEnterForegroundNotification]) {
-            [self dispatchApplicationWillEnterForeground];
-        } else if ([name isEqualToString:WKApplicationWillResignActiveNotification]) {
-            [self dispatchApplicationWillResignActive];
-        } else if ([name isEqualToString:WKApplicationDidEnterBackgroundNotification]) {
-            [self dispatchApplicationDidEnterBackground];
-        }
+    if (@available(watchOS 7.0, *)) {
+        routes[count++] = (GrowingULNotificationRoute){
+            WKApplicationDidFinishLaunchingNotification, @selector(handleDidFinishLaunching:), NO};
+        routes[count++] = (GrowingULNotificationRoute){
+            WKApplicationDidBecomeActiveNotification, @selector(handleDidBecomeActive:), NO};
+        routes[count++] = (GrowingULNotificationRoute){
+            WKApplicationWillEnterForegroundNotification, @selector(handleWillEnterForeground:), NO};
+        routes[count++] = (GrowingULNotificationRoute){
+            WKApplicationWillResignActiveNotification, @selector(handleWillResignActive:), NO};
+        routes[count++] = (GrowingULNotificationRoute){
+            WKApplicationDidEnterBackgroundNotification, @selector(handleDidEnterBackground:), NO};
     }
 #endif
+    return count;
 }
 
-- (void)addAppLifecycleDelegate:(id)delegate {
-    [self.delegateLock lock];
-    if (![self.lifecycleDelegates.allObjects containsObject:delegate]) {
-        [self.lifecycleDelegates addPointer:(__bridge void *)delegate];
+- (void)setupAppStateNotification {
+    NSNotificationCenter *nc = [NSNotificationCenter defaultCenter];
+    id application = GrowingULCurrentEnvironment().application;
+    GrowingULNotificationRoute routes[GrowingULNotificationRouteMaxCount];
+    NSUInteger count = [self getNotificationRoutes:routes];
+    for (NSUInteger i = 0; i < count; i++) {
+        [nc addObserver:self
+               selector:routes[i].handler
+                   name:routes[i].name
+                 object:routes[i].postedByApplication ? application : nil];
     }
-    [self.delegateLock unlock];
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+- (void)handleDidFinishLaunching:(NSNotification *)notification {
+    [self dispatchApplicationDidFinishLaunching:notification.userInfo];
+}
+
+- (void)handleWillTerminate:(NSNotification *)notification {
+    [self dispatchApplicationWillTerminate];
+}
+
+- (void)handleDidBecomeActive:(NSNotification *)notification {
+    [self dispatchApplicationDidBecomeActive];
+}
+
+- (void)handleWillEnterForeground:(NSNotification *)notification {
+    [self dispatchApplicationWillEnterForeground];
+}
+
+- (void)handleWillResignActive:(NSNotification *)notification {
+    [self dispatchApplicationWillResignActive];
+}
+
+- (void)handleDidEnterBackground:(NSNotification *)notification {
+    [self dispatchApplicationDidEnterBackground];
+}
+
+- (void)handleSceneWillConnect:(NSNotification *)notification {
+    [self dispatchSceneTransition:GrowingULSceneTransitionWillConnect scene:notification.object];
+}
+
+- (void)handleSceneWillEnterForeground:(NSNotification *)notification {
+    [self dispatchSceneTransition:GrowingULSceneTransitionWillEnterForeground scene:notification.object];
+}
+
+- (void)handleSceneDidActivate:(NSNotification *)notification {
+    [self dispatchSceneTransition:GrowingULSceneTransitionDidActivate scene:notification.object];
+}
+
+- (void)handleSceneWillDeactivate:(NSNotification *)notification {
+    [self dispatchSceneTransition:GrowingULSceneTransitionWillDeactivate scene:notification.object];
+}
+
+- (void)handleSceneDidEnterBackground:(NSNotification *)notification {
+    [self dispatchSceneTransition:GrowingULSceneTransitionDidEnterBackground scene:notification.object];
+}
+
+- (void)handleSceneDidDisconnect:(NSNotification *)notification {
+    [self dispatchSceneTransition:GrowingULSceneTransitionDidDisconnect scene:notification.object];
+}
+
+- (BOOL)isLatencyInstrumentationEnabled {
+    return self.delegateRegistry.latencyInstrumentationEnabled;
+}
+
+- (void)setLatencyInstrumentationEnabled:(BOOL)latencyInstrumentationEnabled {
+    self.delegateRegistry.latencyInstrumentationEnabled = latencyInstrumentationEnabled;
+}
+
+- (NSArray<GrowingULDelegateLatency *> *)delegateLatencySnapshot {
+    return [self.delegateRegistry latencySnapshot];
+}
+
+- (NSUInteger)droppedEventCount {
+    return self.delegateRegistry.droppedEventCount;
+}
+
+- (void)setDeliveryMode:(GrowingULLifecycleDeliveryMode)deliveryMode {
+    _deliveryMode = deliveryMode;
+    self.delegateRegistry.asynchronousDelivery = (deliveryMode == GrowingULLifecycleDeliveryModeAsynchronous);
+}
+
+- (void)addAppLifecycleDelegate:(id)delegate {
+    [self.delegateRegistry addDelegate:delegate];
 }
 
 - (void)removeAppLifecycleDelegate:(id)delegate {
-    [self.delegateLock lock];
-    [self.lifecycleDelegates.allObjects enumerateObjectsWithOptions:NSEnumerationReverse
-                                                         usingBlock:^(NSObject *obj,
-                                                                      NSUInteger idx,
-                                                                      BOOL *_Nonnull stop) {
-        if (delegate == obj) {
-            [self.lifecycleDelegates removePointerAtIndex:idx];
-            *stop = YES;
-        }
-    }];
-    [self.delegateLock unlock];
+    [self.delegateRegistry removeDelegate:delegate];
 }
 
-- (void)dispatchApplicationDidFinishLaunching:(NSDictionary *)userInfo {
-    self.appDidFinishLaunchingTime = [GrowingULTimeUtil currentSystemTimeMillis];
+- (void)postEventWithType:(GrowingULLifecycleEventType)type {
+    GrowingULEventJournal *journal = self.eventJournal;
+    GrowingULStallMonitor *stallMonitor = self.stallMonitor;
+    BOOL asynchronous = self.delegateRegistry.asynchronousDelivery;
+    if (!journal && !stallMonitor && !asynchronous) {
+        return;
+    }
+    GrowingULLifecycleEvent event = {
+        .type = type,
+        .timestamp = [self eventTime],
+    };
+    [journal appendEvent:&event];
+    [stallMonitor recordEvent:&event];
+    if (asynchronous) {
+        [self.delegateRegistry postEvent:event];
+    }
+}
 
-    [self.delegateLock lock];
-    for (id delegate in self.lifecycleDelegates) {
-        if ([delegate respondsToSelector:@selector(applicationDidFinishLaunching:)]) {
-            [delegate applicationDidFinishLaunching:userInfo];
+- (void)dispatchApplicationDidFinishLaunching:(NSDictionary *)userInfo {
+    self.appDidFinishLaunchingTime = [self eventTime];
+    GrowingULLaunchTimelineRecordDidFinishLaunching(self.appDidFinishLaunchingTime);
+#if Growing_USE_UIKIT
+    // a turn later: until its launch scene connects, a scene based app is in the background on a user launch too
+    dispatch_async(dispatch_get_main_queue(), ^{
+        UIApplication *application = [GrowingULApplication sharedApplication];
+        if (application && application.applicationState == UIApplicationStateBackground) {
+            GrowingULLaunchTimelineMarkBackgroundLaunch();
         }
-    }
-    [self.delegateLock unlock];
+    });
+#endif
+    [self.delegateRegistry dispatchSelectorAtIndex:GrowingULAppCallbackDidFinishLaunching withObject:userInfo];
+    [self postEventWithType:GrowingULLifecycleEventTypeApplicationDidFinishLaunching];
 }
 
 - (void)dispatchApplicationWillTerminate {
-    [self.delegateLock lock];
-    for (id delegate in self.lifecycleDelegates) {
-        if ([delegate respondsToSelector:@selector(applicationWillTerminate)]) {
-            [delegate applicationWillTerminate];
-        }
-    }
-    [self.delegateLock unlock];
+    [self.delegateRegistry dispatchSelectorAtIndex:GrowingULAppCallbackWillTerminate];
+    [self postEventWithType:GrowingULLifecycleEventTypeApplicationWillTerminate];
 }
 
 - (void)dispatchApplicationDidEnterBackground {
-    self.appDidEnterBackgroundTime = [GrowingULTimeUtil currentSystemTimeMillis];
-
-    [self.delegateLock lock];
-    for (id delegate in self.lifecycleDelegates) {
-        if ([delegate respondsToSelector:@selector(applicationDidEnterBackground)]) {
-            [delegate applicationDidEnterBackground];
-        }
-    }
-    [self.delegateLock unlock];
+    self.appDidEnterBackgroundTime = [self eventTime];
+    [self.delegateRegistry dispatchSelectorAtIndex:GrowingULAppCallbackDidEnterBackground];
+    [self postEventWithType:GrowingULLifecycleEventTypeApplicationDidEnterBackground];
 }
 
 - (void)dispatchApplicationDidBecomeActive {
-    self.appDidBecomeActiveTime = [GrowingULTimeUtil currentSystemTimeMillis];
+    self.appDidBecomeActiveTime = [self eventTime];
+    [self.delegateRegistry dispatchSelectorAtIndex:GrowingULAppCallbackDidBecomeActive];
+    [self postEventWithType:GrowingULLifecycleEventTypeApplicationDidBecomeActive];
+    GrowingULLaunchTimelineRecordDidBecomeActive(self.appDidBecomeActiveTime);
+}
 
-    [self.delegateLock lock];
-    for (id delegate in self.lifecycleDelegates) {
-        if ([delegate respondsToSelector:@selector(applicationDidBecomeActive)]) {
-            [delegate applicationDidBecomeActive];
-        }
+// Delivers the transition on the per-scene channel, then the application events of the aggregate state, if any.
+- (void)dispatchSceneTransition:(GrowingULSceneTransition)transition scene:(id)scene {
+    if (!scene) {
+        return;
+    }
+    GrowingULSceneEvent event = {
+        .scene = scene,
+        .transition = transition,
+        .timestamp = [self eventTime],
+    };
+    GrowingULLifecycleEventType applicationEvents[GrowingULSceneTransitionMaxApplicationEvents];
+    NSUInteger count = [_sceneStates applyTransition:transition
+                                             toScene:(__bridge const void *)scene
+                                       previousState:&event.previousState
+                                              events:applicationEvents];
+    event.state = [_sceneStates stateOfScene:(__bridge const void *)scene];
+    [self.delegateRegistry dispatchSelectorAtIndex:GrowingULAppCallbackSceneDidTransition withPointer:&event];
+    for (NSUInteger i = 0; i < count; i++) {
+        [self dispatchApplicationEventWithType:applicationEvents[i]];
     }
-    [self.delegateLock unlock];
 }
 
-- (void)dispatchApplicationWillResignActive {
-    self.appWillResignActiveTime = [GrowingULTimeUtil currentSystemTimeMillis];
-
-    [self.delegateLock lock];
-    for (id delegate in self.lifecycleDelegates) {
-        if ([delegate respondsToSelector:@selector(applicationWillResignActive)]) {
-            [delegate applicationWillResignActive];
-        }
+- (void)dispatchApplicationEventWithType:(GrowingULLifecycleEventType)type {
+    switch (type) {
+        case GrowingULLifecycleEventTypeApplicationWillEnterForeground:
+            [self dispatchApplicationWillEnterForeground];
+            break;
+        case GrowingULLifecycleEventTypeApplicationDidBecomeActive:
+            [self dispatchApplicationDidBecomeActive];
+            break;
+        case GrowingULLifecycleEventTypeApplicationWillResignActive:
+            [self dispatchApplicationWillResignActive];
+            break;
+        case GrowingULLifecycleEventTypeApplicationDidEnterBackground:
+            [self dispatchApplicationDidEnterBackground];
+            break;
+        default:
+            break;
     }
-    [self.delegateLock unlock];
 }
 
-- (void)dispatchApplicationWillEnterForeground {
-    self.appWillEnterForegroundTime = [GrowingULTimeUtil currentSystemTimeMillis];
+// called by the launch timeline once it completes
+- (void)dispatchApplicationDidCompleteLaunch:(const GrowingULLaunchTimeline *)timeline {
+    [self.delegateRegistry dispatchSelectorAtIndex:GrowingULAppCallbackDidCompleteLaunch withPointer:timeline];
+}
 
-    [self.delegateLock lock];
-    for (id delegate in self.lifecycleDelegates) {
-        if ([delegate respondsToSelector:@selector(applicationWillEnterForeground)]) {
-            [delegate applicationWillEnterForeground];
-        }
-    }
-    [self.delegateLock unlock];
+- (void)dispatchApplicationWillResignActive {
+    self.appWillResignActiveTime = [self eventTime];
+    [self.delegateRegistry dispatchSelectorAtIndex:GrowingULAppCallbackWillResignActive];
+    [self postEventWithType:GrowingULLifecycleEventTypeApplicationWillResignActive];
+}
+
+- (void)dispatchApplicationWillEnterForeground {
+    self.appWillEnterForegroundTime = [self eventTime];
+    [self.delegateRegistry dispatchSelectorAtIndex:GrowingULAppCallbackWillEnterForeground];
+    [self postEventWithType:GrowingULLifecycleEventTypeApplicationWillEnterForeground];
 }
 
 @end
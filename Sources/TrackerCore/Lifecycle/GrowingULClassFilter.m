@@ -0,0 +1,142 @@
+//
+//  GrowingULClassFilter.m
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingULClassFilter.h"
+#import "GrowingULClassTable.h"
+#import <objc/runtime.h>
+
+// One side of the filter, inclusions or exclusions.
+@interface GrowingULClassFilterRules : NSObject <NSCopying>
+
+@property (nonatomic, strong, readonly) NSMutableSet<Class> *classes;
+@property (nonatomic, strong, readonly) NSMutableArray<NSString *> *prefixes;
+@property (nonatomic, strong, readonly) NSMutableSet<NSString *> *bundlePaths;
+
+@end
+
+@implementation GrowingULClassFilterRules
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _classes = [NSMutableSet set];
+        _prefixes = [NSMutableArray array];
+        _bundlePaths = [NSMutableSet set];
+    }
+    return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    GrowingULClassFilterRules *rules = [[GrowingULClassFilterRules alloc] init];
+    [rules.classes unionSet:_classes];
+    [rules.prefixes addObjectsFromArray:_prefixes];
+    [rules.bundlePaths unionSet:_bundlePaths];
+    return rules;
+}
+
+- (BOOL)isEmpty {
+    return _classes.count == 0 && _prefixes.count == 0 && _bundlePaths.count == 0;
+}
+
+- (BOOL)matchesClass:(Class)cls {
+    if (_classes.count > 0) {
+        for (Class current = cls; current; current = class_getSuperclass(current)) {
+            if ([_classes containsObject:current]) {
+                return YES;
+            }
+        }
+    }
+    if (_prefixes.count > 0) {
+        NSString *name = GrowingULClassNameForClass(cls);
+        for (NSString *prefix in _prefixes) {
+            if ([name hasPrefix:prefix]) {
+                return YES;
+            }
+        }
+    }
+    if (_bundlePaths.count > 0) {
+        NSString *path = [NSBundle bundleForClass:cls].bundlePath;
+        if (path && [_bundlePaths containsObject:path]) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+@end
+
+@implementation GrowingULClassFilter {
+    GrowingULClassFilterRules *_included;
+    GrowingULClassFilterRules *_excluded;
+}
+
++ (instancetype)mainBundleFilter {
+    GrowingULClassFilter *filter = [[self alloc] init];
+    [filter includeBundle:NSBundle.mainBundle];
+    return filter;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _included = [[GrowingULClassFilterRules alloc] init];
+        _excluded = [[GrowingULClassFilterRules alloc] init];
+    }
+    return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    GrowingULClassFilter *filter = [[GrowingULClassFilter alloc] init];
+    filter->_included = [_included copy];
+    filter->_excluded = [_excluded copy];
+    return filter;
+}
+
+- (void)includeClass:(Class)cls {
+    [_included.classes addObject:cls];
+}
+
+- (void)excludeClass:(Class)cls {
+    [_excluded.classes addObject:cls];
+}
+
+- (void)includeClassPrefix:(NSString *)prefix {
+    [_included.prefixes addObject:[prefix copy]];
+}
+
+- (void)excludeClassPrefix:(NSString *)prefix {
+    [_excluded.prefixes addObject:[prefix copy]];
+}
+
+- (void)includeBundle:(NSBundle *)bundle {
+    [_included.bundlePaths addObject:bundle.bundlePath];
+}
+
+- (void)excludeBundle:(NSBundle *)bundle {
+    [_excluded.bundlePaths addObject:bundle.bundlePath];
+}
+
+- (BOOL)acceptsClass:(Class)cls {
+    if ([_excluded matchesClass:cls]) {
+        return NO;
+    }
+    return [_included isEmpty] || [_included matchesClass:cls];
+}
+
+@end
@@ -0,0 +1,965 @@
+//
+//  GrowingULDelegateRegistry.m
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingULDelegateRegistry.h"
+#import "GrowingULLifecycleEventQueue.h"
+#import "GrowingULLatencyHistogram.h"
+#import "GrowingULPointerMap.h"
+#import "GrowingULTimeUtil.h"
+#import <objc/runtime.h>
+#import <os/lock.h>
+#import <pthread.h>
+#import <sched.h>
+#import <stdatomic.h>
+
+// filtered delegates get one of the bits below GrowingULDelegateAudienceUnfiltered
+#define GrowingULDelegateFilterSlotCount 63
+// nested delegate calls a thread publishes, deeper ones retain the delegate instead
+#define GrowingULDelegateCallMaxDepth 8
+
+@class GrowingULDelegateRecord;
+
+typedef struct {
+    // owned by the snapshot; does not retain the delegate
+    __unsafe_unretained GrowingULDelegateRecord *record;
+    // class of the delegate when it was registered, imp is only valid for it
+    __unsafe_unretained Class cls;
+    IMP imp;
+    // shared by all delegates of the same class, recorded into only when latency instrumentation is on
+    GrowingULLatencyHistogram *histogram;
+    // bit of the delegate in an audience mask
+    uint64_t audience;
+} GrowingULDelegateEntry;
+
+typedef struct {
+    GrowingULDelegateEntry *entries;
+    NSUInteger count;
+} GrowingULDelegateList;
+
+static inline void GrowingULDelegateListAppend(GrowingULDelegateList *list,
+                                               __unsafe_unretained GrowingULDelegateRecord *record,
+                                               __unsafe_unretained Class cls,
+                                               IMP imp,
+                                               GrowingULLatencyHistogram *histogram,
+                                               uint64_t audience) {
+    list->entries[list->count].record = record;
+    list->entries[list->count].cls = cls;
+    list->entries[list->count].imp = imp;
+    list->entries[list->count].histogram = histogram;
+    list->entries[list->count].audience = audience;
+    list->count++;
+}
+
+// Resolved once when the delegate is registered. The delegate is not retained, as with the NSPointerArray the hubs
+// used to keep; records of deallocated delegates are pruned when the next snapshot is built.
+@interface GrowingULDelegateRecord : NSObject {
+@public
+    __weak id _delegate;
+    // called without a weak load while _dead is false, see GrowingULDelegateCallBegin
+    __unsafe_unretained id _target;
+    // set once the delegate is removed or deallocating, no call starts after it
+    atomic_bool _dead;
+    // address of the delegate, still valid for removal while it deallocates
+    const void *_identity;
+    // class of the delegate at registration, the IMPs below belong to it
+    Class _class;
+    IMP *_imps;
+    IMP _eventIMP;
+    IMP _batchIMP;
+    // per-class histograms, one per selector followed by the event and batch callbacks; owned by the registry
+    GrowingULLatencyHistogram **_histograms;
+}
+
+@property (nonatomic, weak, readonly) id delegate;
+@property (nonatomic, assign, readonly) uint64_t capabilities;
+/// a private copy, nil for unfiltered delegates
+@property (nonatomic, copy) GrowingULClassFilter *filter;
+/// GrowingULDelegateAudienceUnfiltered or the bit of the delegate's filter slot
+@property (nonatomic, assign) uint64_t audience;
+/// implements -lifecycleDidReceiveEvent: and does not require the main thread
+@property (nonatomic, assign, readonly) BOOL acceptsAsynchronousEvents;
+/// implements -lifecycleDidReceiveEvents:count:
+@property (nonatomic, assign, readonly) BOOL acceptsEventBatches;
+
+@end
+
+@implementation GrowingULDelegateRecord
+
+- (instancetype)initWithDelegate:(id)delegate selectors:(const SEL *)selectors count:(NSUInteger)count {
+    self = [super init];
+    if (self) {
+        _delegate = delegate;
+        _target = delegate;
+        atomic_init(&_dead, false);
+        _identity = (__bridge const void *)delegate;
+        _imps = calloc(MAX(count, 1), sizeof(IMP));
+        Class cls = object_getClass(delegate);
+        _class = cls;
+        for (NSUInteger i = 0; i < count; i++) {
+            if ([delegate respondsToSelector:selectors[i]]) {
+                _capabilities |= (1ULL << i);
+                // _objc_msgForward is returned for forwarded selectors, which is still callable as an IMP
+                _imps[i] = class_getMethodImplementation(cls, selectors[i]);
+            }
+        }
+        if ([delegate respondsToSelector:@selector(lifecycleDidReceiveEvent:)]) {
+            BOOL requiresMainThread = YES;
+            if ([delegate respondsToSelector:@selector(lifecycleDelegateRequiresMainThread)]) {
+                requiresMainThread = [(id<GrowingULLifecycleEventDelegate>)delegate lifecycleDelegateRequiresMainThread];
+            }
+            if (!requiresMainThread) {
+                _acceptsAsynchronousEvents = YES;
+                _eventIMP = class_getMethodImplementation(cls, @selector(lifecycleDidReceiveEvent:));
+            }
+        }
+        if ([delegate respondsToSelector:@selector(lifecycleDidReceiveEvents:count:)]) {
+            _acceptsEventBatches = YES;
+            _batchIMP = class_getMethodImplementation(cls, @selector(lifecycleDidReceiveEvents:count:));
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_imps);
+}
+
+@end
+
+#pragma mark - Calls
+
+// Delegates are called without being retained. Before each call the thread publishes the record it calls into, then
+// checks that the record is not dead; a delegate being removed or deallocated marks its records dead, then waits for
+// the calls other threads have published. Both sides store before they load, with sequentially consistent
+// atomics, so either the caller sees the mark or the remover sees the call.
+typedef struct GrowingULDelegateCallThread {
+    // set before the thread is published, never changed after
+    struct GrowingULDelegateCallThread *next;
+    // records called into, outermost first; written by the owning thread only
+    _Atomic(const void *) records[GrowingULDelegateCallMaxDepth];
+    uint32_t depth;
+    // threads are never freed, an exited thread's entry is reused by the next one
+    atomic_bool inUse;
+} GrowingULDelegateCallThread;
+
+static _Atomic(GrowingULDelegateCallThread *) growingul_delegateCallThreads;
+static pthread_key_t growingul_delegateCallThreadKey;
+static __thread GrowingULDelegateCallThread *growingul_currentDelegateCallThread;
+
+static void GrowingULDelegateCallThreadExit(void *value) {
+    GrowingULDelegateCallThread *thread = value;
+    atomic_store_explicit(&thread->inUse, false, memory_order_release);
+    growingul_currentDelegateCallThread = NULL;
+}
+
+static GrowingULDelegateCallThread *GrowingULCurrentDelegateCallThread(void) {
+    GrowingULDelegateCallThread *thread = growingul_currentDelegateCallThread;
+    if (__builtin_expect(thread != NULL, 1)) {
+        return thread;
+    }
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pthread_key_create(&growingul_delegateCallThreadKey, GrowingULDelegateCallThreadExit);
+    });
+    for (thread = atomic_load(&growingul_delegateCallThreads); thread; thread = thread->next) {
+        bool inUse = false;
+        if (atomic_compare_exchange_strong(&thread->inUse, &inUse, true)) {
+            break;
+        }
+    }
+    if (!thread) {
+        thread = calloc(1, sizeof(GrowingULDelegateCallThread));
+        atomic_init(&thread->inUse, true);
+        GrowingULDelegateCallThread *head = atomic_load(&growingul_delegateCallThreads);
+        do {
+            thread->next = head;
+        } while (!atomic_compare_exchange_weak(&growingul_delegateCallThreads, &head, thread));
+    }
+    thread->depth = 0;
+    pthread_setspecific(growingul_delegateCallThreadKey, thread);
+    growingul_currentDelegateCallThread = thread;
+    return thread;
+}
+
+// Returns once no other thread is calling into record. Calls of the current thread are not waited for: a delegate
+// released from one of its own callbacks could never see them return.
+static void GrowingULDelegateWaitForCalls(GrowingULDelegateRecord *record) {
+    const void *key = (__bridge const void *)record;
+    GrowingULDelegateCallThread *current = growingul_currentDelegateCallThread;
+    for (GrowingULDelegateCallThread *thread = atomic_load(&growingul_delegateCallThreads); thread;
+         thread = thread->next) {
+        if (thread == current) {
+            continue;
+        }
+        for (NSUInteger i = 0; i < GrowingULDelegateCallMaxDepth; i++) {
+            while (atomic_load(&thread->records[i]) == key) {
+                sched_yield();
+            }
+        }
+    }
+}
+
+// Associated with the delegate for each registration. It is released when the delegate is removed, or once the
+// deallocating delegate has run -dealloc, and in both cases keeps the delegate's memory from being freed while
+// another thread is still calling into it.
+@interface GrowingULDelegateSentinel : NSObject {
+@public
+    GrowingULDelegateRecord *_record;
+}
+@end
+
+@implementation GrowingULDelegateSentinel
+
+- (void)dealloc {
+    atomic_store(&_record->_dead, true);
+    GrowingULDelegateWaitForCalls(_record);
+}
+
+@end
+
+typedef struct {
+    __unsafe_unretained id target;
+    IMP imp;
+    // the published call, NULL when the delegate was retained instead
+    _Atomic(const void *) *slot;
+    const void *retained;
+} GrowingULDelegateCall;
+
+static inline void GrowingULDelegateCallEnd(GrowingULDelegateCall *call) {
+    if (call->slot) {
+        atomic_store_explicit(call->slot, NULL, memory_order_release);
+        growingul_currentDelegateCallThread->depth--;
+    } else if (call->retained) {
+        CFRelease(call->retained);
+    }
+}
+
+// Prepares a call into the delegate of entry, NO if it must be skipped because it was removed or is deallocating.
+// The IMP is the one cached at registration unless the delegate has changed class since (KVO, isa swizzling).
+static inline BOOL GrowingULDelegateCallBegin(const GrowingULDelegateEntry *entry, SEL selector,
+                                              GrowingULDelegateCall *call) {
+    __unsafe_unretained GrowingULDelegateRecord *record = entry->record;
+    GrowingULDelegateCallThread *thread = GrowingULCurrentDelegateCallThread();
+    call->slot = NULL;
+    call->retained = NULL;
+    if (__builtin_expect(thread->depth < GrowingULDelegateCallMaxDepth, 1)) {
+        call->slot = &thread->records[thread->depth++];
+        atomic_store(call->slot, (__bridge const void *)record);
+        if (atomic_load(&record->_dead)) {
+            GrowingULDelegateCallEnd(call);
+            return NO;
+        }
+        call->target = record->_target;
+    } else {
+        call->retained = (__bridge_retained const void *)record->_delegate;
+        if (!call->retained || atomic_load(&record->_dead)) {
+            GrowingULDelegateCallEnd(call);
+            return NO;
+        }
+        call->target = (__bridge id)call->retained;
+    }
+    Class cls = object_getClass(call->target);
+    call->imp = cls == entry->cls ? entry->imp : class_getMethodImplementation(cls, selector);
+    return YES;
+}
+
+@interface GrowingULDelegateSnapshot : NSObject {
+@public
+    GrowingULDelegateList *_lists;
+    NSUInteger _listCount;
+    // delegates receiving GrowingULLifecycleEvent records, empty unless delivery is asynchronous
+    GrowingULDelegateList _eventList;
+    // delegates receiving batches of records, empty unless delivery is batched
+    GrowingULDelegateList _batchList;
+}
+
+// owns the records referenced by _lists
+@property (nonatomic, copy, readonly) NSArray<GrowingULDelegateRecord *> *records;
+
+@end
+
+@implementation GrowingULDelegateSnapshot
+
+- (instancetype)initWithRecords:(NSArray<GrowingULDelegateRecord *> *)records
+                          count:(NSUInteger)count
+                   asynchronous:(BOOL)asynchronous
+                        batched:(BOOL)batched {
+    self = [super init];
+    if (self) {
+        _records = [records copy];
+        _listCount = count;
+        _lists = calloc(MAX(count, 1), sizeof(GrowingULDelegateList));
+        for (NSUInteger i = 0; i < count; i++) {
+            _lists[i].entries = calloc(MAX(_records.count, 1), sizeof(GrowingULDelegateEntry));
+        }
+        _eventList.entries = calloc(MAX(_records.count, 1), sizeof(GrowingULDelegateEntry));
+        _batchList.entries = calloc(MAX(_records.count, 1), sizeof(GrowingULDelegateEntry));
+
+        // Each delegate is served by exactly one route: asynchronous events win over batches,
+        // batches win over the per-callback methods.
+        for (GrowingULDelegateRecord *record in _records) {
+            if (asynchronous && record.acceptsAsynchronousEvents) {
+                GrowingULDelegateListAppend(&_eventList, record, record->_class, record->_eventIMP,
+                                            record->_histograms[count], record.audience);
+            } else if (batched && record.acceptsEventBatches) {
+                GrowingULDelegateListAppend(&_batchList, record, record->_class, record->_batchIMP,
+                                            record->_histograms[count + 1], record.audience);
+            } else {
+                for (NSUInteger i = 0; i < count; i++) {
+                    if (record.capabilities & (1ULL << i)) {
+                        GrowingULDelegateListAppend(&_lists[i], record, record->_class, record->_imps[i],
+                                                    record->_histograms[i], record.audience);
+                    }
+                }
+            }
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i < _listCount; i++) {
+        free(_lists[i].entries);
+    }
+    free(_lists);
+    free(_eventList.entries);
+    free(_batchList.entries);
+}
+
+@end
+
+// Filter verdicts of one generation of filters, never changed once published: a miss publishes a copy holding the
+// new verdict, a filter change an empty table.
+@interface GrowingULVerdictTable : NSObject {
+@public
+    // class -> uint64_t mask of the filter slots accepting it
+    GrowingULPointerMap *_verdicts;
+    // the filtered records the verdicts were evaluated with
+    NSArray<GrowingULDelegateRecord *> *_filteredRecords;
+    // bumped whenever the filters change, a verdict is only added to a table of the generation it was evaluated in
+    uint64_t _generation;
+}
+@end
+
+@implementation GrowingULVerdictTable
+
+- (instancetype)initWithFilteredRecords:(NSArray<GrowingULDelegateRecord *> *)filteredRecords
+                             generation:(uint64_t)generation {
+    self = [super init];
+    if (self) {
+        _verdicts = GrowingULPointerMapCreate(sizeof(uint64_t));
+        _filteredRecords = [filteredRecords copy];
+        _generation = generation;
+    }
+    return self;
+}
+
+- (instancetype)initWithTable:(GrowingULVerdictTable *)table {
+    self = [self initWithFilteredRecords:table->_filteredRecords generation:table->_generation];
+    if (self) {
+        GrowingULPointerMap *verdicts = _verdicts;
+        GrowingULPointerMapEnumerate(table->_verdicts, ^(const void *key, void *value, BOOL *stop) {
+            *(uint64_t *)GrowingULPointerMapGetOrInsert(verdicts, key, NULL) = *(uint64_t *)value;
+        });
+    }
+    return self;
+}
+
+- (void)dealloc {
+    GrowingULPointerMapDestroy(_verdicts);
+}
+
+@end
+
+@implementation GrowingULDelegateRegistry {
+    SEL *_selectors;
+    NSUInteger _selectorCount;
+    NSLock *_lock;
+    // guarded by _lock
+    NSMutableArray<GrowingULDelegateRecord *> *_records;
+    // +1 GrowingULDelegateSnapshot, swapped under _lock, read without it
+    _Atomic(void *) _snapshot;
+    atomic_ulong _readers;
+    os_unfair_lock _retiredLock;
+    // guarded by _retiredLock; swapped out snapshots and verdict tables, released once no reader is active
+    NSMutableArray *_retiredObjects;
+    atomic_bool _hasRetiredObjects;
+    atomic_bool _asynchronousDelivery;
+    atomic_bool _batchedDelivery;
+    atomic_bool _latencyInstrumentation;
+    // guarded by _lock; delegate class -> GrowingULLatencyHistogram *[_selectorCount + 2], kept for the
+    // registry's lifetime so that statistics survive removing a delegate
+    GrowingULPointerMap *_classHistograms;
+    // created the first time asynchronous delivery is enabled
+    GrowingULLifecycleEventQueue *_eventQueue;
+    // guarded by _lock; filter slots in use
+    uint64_t _filterSlots;
+    // mirrors _filterSlots, read without a lock to skip verdict lookups while no delegate is filtered
+    atomic_ullong _filterSlotsInUse;
+    atomic_ulong _unfilteredCount;
+    // serializes the publications of _verdictTable
+    os_unfair_lock _verdictLock;
+    // +1 GrowingULVerdictTable, swapped under _verdictLock and retired like snapshots, read without a lock
+    _Atomic(void *) _verdictTable;
+}
+
+// Leaves a section started with atomic_fetch_add(&_readers, 1); the last reader leaving releases retired objects.
+static inline void GrowingULDelegateRegistryEndReading(GrowingULDelegateRegistry *registry) {
+    if (atomic_fetch_sub(&registry->_readers, 1) == 1 && atomic_load(&registry->_hasRetiredObjects)) {
+        [registry releaseRetiredObjects];
+    }
+}
+
+- (instancetype)initWithSelectors:(const SEL *)selectors count:(NSUInteger)count {
+    NSParameterAssert(count <= 64);
+    self = [super init];
+    if (self) {
+        _selectors = malloc(MAX(count, 1) * sizeof(SEL));
+        memcpy(_selectors, selectors, count * sizeof(SEL));
+        _selectorCount = count;
+        _lock = [[NSLock alloc] init];
+        _records = [NSMutableArray array];
+        _retiredLock = OS_UNFAIR_LOCK_INIT;
+        _retiredObjects = [NSMutableArray array];
+        atomic_init(&_hasRetiredObjects, false);
+        GrowingULDelegateSnapshot *snapshot = [[GrowingULDelegateSnapshot alloc] initWithRecords:_records
+                                                                                          count:_selectorCount
+                                                                                   asynchronous:NO
+                                                                                        batched:NO];
+        atomic_init(&_snapshot, (__bridge_retained void *)snapshot);
+        atomic_init(&_readers, 0);
+        atomic_init(&_asynchronousDelivery, false);
+        atomic_init(&_batchedDelivery, false);
+        atomic_init(&_latencyInstrumentation, false);
+        _classHistograms = GrowingULPointerMapCreate(sizeof(GrowingULLatencyHistogram **));
+        atomic_init(&_filterSlotsInUse, 0);
+        atomic_init(&_unfilteredCount, 0);
+        _verdictLock = OS_UNFAIR_LOCK_INIT;
+        GrowingULVerdictTable *verdictTable = [[GrowingULVerdictTable alloc] initWithFilteredRecords:@[] generation:0];
+        atomic_init(&_verdictTable, (__bridge_retained void *)verdictTable);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    void *snapshot = atomic_exchange(&_snapshot, NULL);
+    if (snapshot) {
+        CFRelease(snapshot);
+    }
+    void *verdictTable = atomic_exchange(&_verdictTable, NULL);
+    if (verdictTable) {
+        CFRelease(verdictTable);
+    }
+    free(_selectors);
+    NSUInteger slotCount = _selectorCount + 2;
+    GrowingULPointerMapEnumerate(_classHistograms, ^(const void *key, void *value, BOOL *stop) {
+        GrowingULLatencyHistogram **histograms = *(GrowingULLatencyHistogram ***)value;
+        for (NSUInteger i = 0; i < slotCount; i++) {
+            GrowingULLatencyHistogramDestroy(histograms[i]);
+        }
+        free(histograms);
+    });
+    GrowingULPointerMapDestroy(_classHistograms);
+}
+
+- (void)addDelegate:(id)delegate {
+    [self addDelegate:delegate classFilter:nil];
+}
+
+- (void)addDelegate:(id)delegate classFilter:(GrowingULClassFilter *)filter {
+    if (!delegate) {
+        return;
+    }
+    GrowingULDelegateRecord *record = nil;
+    [_lock lock];
+    // a new delegate may have the address of a deallocated one
+    BOOL pruned = [self pruneDeallocatedRecordsLocked];
+    if ([self indexOfDelegateLocked:delegate] == NSNotFound) {
+        record = [[GrowingULDelegateRecord alloc] initWithDelegate:delegate
+                                                         selectors:_selectors
+                                                             count:_selectorCount];
+        record->_histograms = [self histogramsForRecordLocked:record];
+        record.audience = GrowingULDelegateAudienceUnfiltered;
+        if (filter) {
+            uint64_t freeSlots = ~_filterSlots & (GrowingULDelegateAudienceUnfiltered - 1);
+            NSAssert(freeSlots != 0, @"at most %d delegates can be filtered", GrowingULDelegateFilterSlotCount);
+            if (freeSlots != 0) {
+                record.filter = filter;
+                record.audience = freeSlots & -freeSlots;
+            }
+        }
+        [_records addObject:record];
+        if (record.filter) {
+            _filterSlots |= record.audience;
+            [self publishFiltersLocked];
+        } else {
+            atomic_fetch_add(&_unfilteredCount, 1);
+        }
+        [self publishSnapshotLocked];
+    } else if (pruned) {
+        [self publishSnapshotLocked];
+    }
+    [_lock unlock];
+    if (record) {
+        GrowingULDelegateSentinel *sentinel = [[GrowingULDelegateSentinel alloc] init];
+        sentinel->_record = record;
+        objc_setAssociatedObject(delegate, (__bridge const void *)record, sentinel, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    [self releaseRetiredObjects];
+}
+
+- (void)removeDelegate:(id)delegate {
+    if (!delegate) {
+        return;
+    }
+    GrowingULDelegateRecord *record = nil;
+    [_lock lock];
+    // a delegate removing itself from -dealloc is already pruned here
+    BOOL pruned = [self pruneDeallocatedRecordsLocked];
+    NSUInteger index = [self indexOfDelegateLocked:delegate];
+    if (index != NSNotFound) {
+        record = _records[index];
+        [_records removeObjectAtIndex:index];
+        [self releaseAudienceOfRecordLocked:record];
+    }
+    if (index != NSNotFound || pruned) {
+        [self publishSnapshotLocked];
+    }
+    [_lock unlock];
+    if (record) {
+        // releases the sentinel, which waits for the calls still running on other threads
+        objc_setAssociatedObject(delegate, (__bridge const void *)record, nil, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    [self releaseRetiredObjects];
+}
+
+- (void)releaseAudienceOfRecordLocked:(GrowingULDelegateRecord *)record {
+    if (record.filter) {
+        _filterSlots &= ~record.audience;
+        [self publishFiltersLocked];
+    } else {
+        atomic_fetch_sub(&_unfilteredCount, 1);
+    }
+}
+
+- (BOOL)pruneDeallocatedRecordsLocked {
+    NSIndexSet *deallocated =
+        [_records indexesOfObjectsPassingTest:^BOOL(GrowingULDelegateRecord *record, NSUInteger idx, BOOL *stop) {
+            return record.delegate == nil;
+        }];
+    if (deallocated.count == 0) {
+        return NO;
+    }
+    for (GrowingULDelegateRecord *record in [_records objectsAtIndexes:deallocated]) {
+        // the sentinel waits for calls in flight once the delegate has run -dealloc
+        atomic_store(&record->_dead, true);
+        [self releaseAudienceOfRecordLocked:record];
+    }
+    [_records removeObjectsAtIndexes:deallocated];
+    return YES;
+}
+
+- (void)publishFiltersLocked {
+    NSMutableArray<GrowingULDelegateRecord *> *filteredRecords = [NSMutableArray array];
+    for (GrowingULDelegateRecord *record in _records) {
+        if (record.filter) {
+            [filteredRecords addObject:record];
+        }
+    }
+    os_unfair_lock_lock(&_verdictLock);
+    __unsafe_unretained GrowingULVerdictTable *current =
+        (__bridge GrowingULVerdictTable *)atomic_load(&_verdictTable);
+    GrowingULVerdictTable *table = [[GrowingULVerdictTable alloc] initWithFilteredRecords:filteredRecords
+                                                                              generation:current->_generation + 1];
+    [self retireObject:(__bridge_transfer id)atomic_exchange(&_verdictTable, (__bridge_retained void *)table)];
+    os_unfair_lock_unlock(&_verdictLock);
+    atomic_store_explicit(&_filterSlotsInUse, _filterSlots, memory_order_relaxed);
+}
+
+- (uint64_t)audienceForClass:(Class)cls {
+    uint64_t audience = atomic_load_explicit(&_unfilteredCount, memory_order_relaxed) > 0
+                            ? GrowingULDelegateAudienceUnfiltered
+                            : 0;
+    uint64_t slots = atomic_load_explicit(&_filterSlotsInUse, memory_order_relaxed);
+    if (slots == 0) {
+        return audience;
+    }
+    if (!cls) {
+        return audience | slots;
+    }
+
+    // the table is pinned like a snapshot, cached verdicts are read without a lock
+    atomic_fetch_add(&_readers, 1);
+    __unsafe_unretained GrowingULVerdictTable *table =
+        (__bridge GrowingULVerdictTable *)atomic_load(&_verdictTable);
+    uint64_t *cached = GrowingULPointerMapGet(table->_verdicts, (__bridge const void *)cls);
+    uint64_t verdict = cached ? *cached : 0;
+    NSArray<GrowingULDelegateRecord *> *filteredRecords = cached ? nil : table->_filteredRecords;
+    uint64_t generation = table->_generation;
+    GrowingULDelegateRegistryEndReading(self);
+    if (cached) {
+        return audience | verdict;
+    }
+
+    // evaluated outside of the lock, filters may look up class names and bundles
+    for (GrowingULDelegateRecord *record in filteredRecords) {
+        if ([record.filter acceptsClass:cls]) {
+            verdict |= record.audience;
+        }
+    }
+
+    os_unfair_lock_lock(&_verdictLock);
+    __unsafe_unretained GrowingULVerdictTable *current =
+        (__bridge GrowingULVerdictTable *)atomic_load(&_verdictTable);
+    if (current->_generation == generation &&
+        !GrowingULPointerMapGet(current->_verdicts, (__bridge const void *)cls)) {
+        GrowingULVerdictTable *updated = [[GrowingULVerdictTable alloc] initWithTable:current];
+        *(uint64_t *)GrowingULPointerMapGetOrInsert(updated->_verdicts, (__bridge const void *)cls, NULL) = verdict;
+        [self retireObject:(__bridge_transfer id)atomic_exchange(&_verdictTable, (__bridge_retained void *)updated)];
+    }
+    os_unfair_lock_unlock(&_verdictLock);
+    [self releaseRetiredObjects];
+    return audience | verdict;
+}
+
+- (GrowingULLatencyHistogram **)histogramsForRecordLocked:(GrowingULDelegateRecord *)record {
+    BOOL inserted = NO;
+    GrowingULLatencyHistogram ***slot =
+        GrowingULPointerMapGetOrInsert(_classHistograms, (__bridge const void *)record->_class, &inserted);
+    if (inserted) {
+        *slot = calloc(_selectorCount + 2, sizeof(GrowingULLatencyHistogram *));
+    }
+    GrowingULLatencyHistogram **histograms = *slot;
+    // only for the callbacks this class can receive
+    for (NSUInteger i = 0; i < _selectorCount; i++) {
+        if ((record.capabilities & (1ULL << i)) && !histograms[i]) {
+            histograms[i] = GrowingULLatencyHistogramCreate();
+        }
+    }
+    if (record.acceptsAsynchronousEvents && !histograms[_selectorCount]) {
+        histograms[_selectorCount] = GrowingULLatencyHistogramCreate();
+    }
+    if (record.acceptsEventBatches && !histograms[_selectorCount + 1]) {
+        histograms[_selectorCount + 1] = GrowingULLatencyHistogramCreate();
+    }
+    return histograms;
+}
+
+- (NSUInteger)indexOfDelegateLocked:(id)delegate {
+    return [_records indexOfObjectPassingTest:^BOOL(GrowingULDelegateRecord *record, NSUInteger idx, BOOL *stop) {
+        return record->_identity == (__bridge const void *)delegate;
+    }];
+}
+
+// The snapshot swapped out is retired, callers release it with -releaseRetiredObjects after unlocking.
+- (void)publishSnapshotLocked {
+    [self pruneDeallocatedRecordsLocked];
+    GrowingULDelegateSnapshot *snapshot =
+        [[GrowingULDelegateSnapshot alloc] initWithRecords:_records
+                                                     count:_selectorCount
+                                              asynchronous:atomic_load(&_asynchronousDelivery)
+                                                   batched:atomic_load(&_batchedDelivery)];
+    [self retireObject:(__bridge_transfer id)atomic_exchange(&_snapshot, (__bridge_retained void *)snapshot)];
+}
+
+// object was swapped out of _snapshot or _verdictTable and may still be read by an active reader
+- (void)retireObject:(id)object {
+    if (!object) {
+        return;
+    }
+    os_unfair_lock_lock(&_retiredLock);
+    [_retiredObjects addObject:object];
+    atomic_store(&_hasRetiredObjects, true);
+    os_unfair_lock_unlock(&_retiredLock);
+}
+
+// Called after publishing and by the last reader leaving. An object is retired only after it was swapped out, and a
+// reader counts itself before loading the pointer: once no reader is active, none of the retired objects can still
+// be in use. Publishing sets _hasRetiredObjects before reading _readers and readers decrement before reading it,
+// so whichever comes last releases them.
+- (void)releaseRetiredObjects {
+    NSMutableArray *retired = nil;
+    os_unfair_lock_lock(&_retiredLock);
+    if (_retiredObjects.count > 0 && atomic_load(&_readers) == 0) {
+        retired = _retiredObjects;
+        _retiredObjects = [NSMutableArray array];
+        atomic_store(&_hasRetiredObjects, false);
+    }
+    os_unfair_lock_unlock(&_retiredLock);
+    // snapshots and tables free their storage outside of the lock
+    [retired removeAllObjects];
+}
+
+- (BOOL)isLatencyInstrumentationEnabled {
+    return atomic_load_explicit(&_latencyInstrumentation, memory_order_relaxed);
+}
+
+- (void)setLatencyInstrumentationEnabled:(BOOL)latencyInstrumentationEnabled {
+    atomic_store_explicit(&_latencyInstrumentation, latencyInstrumentationEnabled, memory_order_relaxed);
+}
+
+- (NSArray<GrowingULDelegateLatency *> *)latencySnapshot {
+    NSMutableArray<GrowingULDelegateLatency *> *latencies = [NSMutableArray array];
+    NSUInteger selectorCount = _selectorCount;
+    SEL *selectors = _selectors;
+    [_lock lock];
+    GrowingULPointerMapEnumerate(_classHistograms, ^(const void *key, void *value, BOOL *stop) {
+        GrowingULLatencyHistogram **histograms = *(GrowingULLatencyHistogram ***)value;
+        for (NSUInteger i = 0; i < selectorCount + 2; i++) {
+            if (!histograms[i]) {
+                continue;
+            }
+            GrowingULLatencySummary summary = GrowingULLatencyHistogramSummarize(histograms[i]);
+            if (summary.count == 0) {
+                continue;
+            }
+            SEL selector = i < selectorCount    ? selectors[i]
+                           : i == selectorCount ? @selector(lifecycleDidReceiveEvent:)
+                                                : @selector(lifecycleDidReceiveEvents:count:);
+            [latencies addObject:[[GrowingULDelegateLatency alloc] initWithDelegateClass:(__bridge Class)key
+                                                                                selector:selector
+                                                                                 summary:summary]];
+        }
+    }];
+    [_lock unlock];
+    return latencies;
+}
+
+- (BOOL)asynchronousDelivery {
+    return atomic_load_explicit(&_asynchronousDelivery, memory_order_acquire);
+}
+
+- (void)setAsynchronousDelivery:(BOOL)asynchronousDelivery {
+    [_lock lock];
+    if (asynchronousDelivery != atomic_load(&_asynchronousDelivery)) {
+        if (asynchronousDelivery && !_eventQueue) {
+            // the queue keeps the registry alive, both are owned by process-wide lifecycle hubs
+            _eventQueue = [[GrowingULLifecycleEventQueue alloc] initWithLabel:"com.growingio.utils.lifecycle.event"
+                                                                     capacity:1024
+                                                                      handler:^(GrowingULLifecycleEvent event) {
+                [self dispatchEvent:event];
+            }];
+        }
+        atomic_store_explicit(&_asynchronousDelivery, asynchronousDelivery, memory_order_release);
+        [self publishSnapshotLocked];
+    }
+    [_lock unlock];
+    [self releaseRetiredObjects];
+}
+
+- (BOOL)batchedDelivery {
+    return atomic_load_explicit(&_batchedDelivery, memory_order_acquire);
+}
+
+- (void)setBatchedDelivery:(BOOL)batchedDelivery {
+    [_lock lock];
+    if (batchedDelivery != atomic_load(&_batchedDelivery)) {
+        atomic_store_explicit(&_batchedDelivery, batchedDelivery, memory_order_release);
+        [self publishSnapshotLocked];
+    }
+    [_lock unlock];
+    [self releaseRetiredObjects];
+}
+
+- (void)dispatchEvents:(const GrowingULLifecycleEvent *)events count:(NSUInteger)count {
+    if (count == 0) {
+        return;
+    }
+    atomic_fetch_add(&_readers, 1);
+    __unsafe_unretained GrowingULDelegateSnapshot *snapshot =
+        (__bridge GrowingULDelegateSnapshot *)atomic_load(&_snapshot);
+    GrowingULDelegateList list = snapshot->_batchList;
+    BOOL timed = atomic_load_explicit(&_latencyInstrumentation, memory_order_relaxed);
+    // filtered delegates receive only the events of classes they accept, resolved once per batch
+    uint64_t *audiences = NULL;
+    GrowingULLifecycleEvent *filtered = NULL;
+    for (NSUInteger i = 0; i < list.count; i++) {
+        const GrowingULLifecycleEvent *delivered = events;
+        NSUInteger deliveredCount = count;
+        if (list.entries[i].audience != GrowingULDelegateAudienceUnfiltered) {
+            if (!audiences) {
+                audiences = malloc(count * sizeof(uint64_t));
+                filtered = malloc(count * sizeof(GrowingULLifecycleEvent));
+                for (NSUInteger j = 0; j < count; j++) {
+                    audiences[j] = [self audienceForClass:events[j].objectClass];
+                }
+            }
+            deliveredCount = 0;
+            for (NSUInteger j = 0; j < count; j++) {
+                if (audiences[j] & list.entries[i].audience) {
+                    filtered[deliveredCount++] = events[j];
+                }
+            }
+            if (deliveredCount == 0) {
+                continue;
+            }
+            delivered = filtered;
+        }
+        GrowingULDelegateCall call;
+        if (!GrowingULDelegateCallBegin(&list.entries[i], @selector(lifecycleDidReceiveEvents:count:), &call)) {
+            continue;
+        }
+        uint64_t start = timed ? GrowingULMonotonicTimeNanos() : 0;
+        ((void (*)(id, SEL, const GrowingULLifecycleEvent *, NSUInteger))call.imp)(
+            call.target, @selector(lifecycleDidReceiveEvents:count:), delivered, deliveredCount);
+        if (timed) {
+            GrowingULLatencyHistogramRecord(list.entries[i].histogram, GrowingULMonotonicTimeNanos() - start);
+        }
+        GrowingULDelegateCallEnd(&call);
+    }
+    free(audiences);
+    free(filtered);
+    GrowingULDelegateRegistryEndReading(self);
+}
+
+- (void)postEvent:(GrowingULLifecycleEvent)event {
+    if (!atomic_load_explicit(&_asynchronousDelivery, memory_order_acquire)) {
+        return;
+    }
+    [_eventQueue enqueueEvent:event];
+}
+
+- (NSUInteger)droppedEventCount {
+    [_lock lock];
+    GrowingULLifecycleEventQueue *eventQueue = _eventQueue;
+    [_lock unlock];
+    return eventQueue.droppedEventCount;
+}
+
+- (void)dispatchEvent:(GrowingULLifecycleEvent)event {
+    atomic_fetch_add(&_readers, 1);
+    __unsafe_unretained GrowingULDelegateSnapshot *snapshot =
+        (__bridge GrowingULDelegateSnapshot *)atomic_load(&_snapshot);
+    GrowingULDelegateList list = snapshot->_eventList;
+    BOOL timed = atomic_load_explicit(&_latencyInstrumentation, memory_order_relaxed);
+    uint64_t audience = [self audienceForClass:event.objectClass];
+    for (NSUInteger i = 0; i < list.count; i++) {
+        if (!(list.entries[i].audience & audience)) {
+            continue;
+        }
+        GrowingULDelegateCall call;
+        if (!GrowingULDelegateCallBegin(&list.entries[i], @selector(lifecycleDidReceiveEvent:), &call)) {
+            continue;
+        }
+        uint64_t start = timed ? GrowingULMonotonicTimeNanos() : 0;
+        ((void (*)(id, SEL, GrowingULLifecycleEvent))call.imp)(
+            call.target, @selector(lifecycleDidReceiveEvent:), event);
+        if (timed) {
+            GrowingULLatencyHistogramRecord(list.entries[i].histogram, GrowingULMonotonicTimeNanos() - start);
+        }
+        GrowingULDelegateCallEnd(&call);
+    }
+    GrowingULDelegateRegistryEndReading(self);
+}
+
+- (uint64_t)capabilitiesOfDelegate:(id)delegate {
+    uint64_t capabilities = 0;
+    [_lock lock];
+    NSUInteger index = [self indexOfDelegateLocked:delegate];
+    if (index != NSNotFound) {
+        capabilities = _records[index].capabilities;
+    }
+    [_lock unlock];
+    return capabilities;
+}
+
+- (void)dispatchSelectorAtIndex:(NSUInteger)index {
+    NSParameterAssert(index < _selectorCount);
+    atomic_fetch_add(&_readers, 1);
+    __unsafe_unretained GrowingULDelegateSnapshot *snapshot =
+        (__bridge GrowingULDelegateSnapshot *)atomic_load(&_snapshot);
+    GrowingULDelegateList list = snapshot->_lists[index];
+    SEL selector = _selectors[index];
+    BOOL timed = atomic_load_explicit(&_latencyInstrumentation, memory_order_relaxed);
+    for (NSUInteger i = 0; i < list.count; i++) {
+        GrowingULDelegateCall call;
+        if (!GrowingULDelegateCallBegin(&list.entries[i], selector, &call)) {
+            continue;
+        }
+        uint64_t start = timed ? GrowingULMonotonicTimeNanos() : 0;
+        ((void (*)(id, SEL))call.imp)(call.target, selector);
+        if (timed) {
+            GrowingULLatencyHistogramRecord(list.entries[i].histogram, GrowingULMonotonicTimeNanos() - start);
+        }
+        GrowingULDelegateCallEnd(&call);
+    }
+    GrowingULDelegateRegistryEndReading(self);
+}
+
+- (void)dispatchSelectorAtIndex:(NSUInteger)index withObject:(id)object {
+    [self dispatchSelectorAtIndex:index withObject:object audience:GrowingULDelegateAudienceAll];
+}
+
+- (void)dispatchSelectorAtIndex:(NSUInteger)index withObject:(id)object audience:(uint64_t)audience {
+    NSParameterAssert(index < _selectorCount);
+    atomic_fetch_add(&_readers, 1);
+    __unsafe_unretained GrowingULDelegateSnapshot *snapshot =
+        (__bridge GrowingULDelegateSnapshot *)atomic_load(&_snapshot);
+    GrowingULDelegateList list = snapshot->_lists[index];
+    SEL selector = _selectors[index];
+    BOOL timed = atomic_load_explicit(&_latencyInstrumentation, memory_order_relaxed);
+    for (NSUInteger i = 0; i < list.count; i++) {
+        if (!(list.entries[i].audience & audience)) {
+            continue;
+        }
+        GrowingULDelegateCall call;
+        if (!GrowingULDelegateCallBegin(&list.entries[i], selector, &call)) {
+            continue;
+        }
+        uint64_t start = timed ? GrowingULMonotonicTimeNanos() : 0;
+        ((void (*)(id, SEL, id))call.imp)(call.target, selector, object);
+        if (timed) {
+            GrowingULLatencyHistogramRecord(list.entries[i].histogram, GrowingULMonotonicTimeNanos() - start);
+        }
+        GrowingULDelegateCallEnd(&call);
+    }
+    GrowingULDelegateRegistryEndReading(self);
+}
+
+- (void)dispatchSelectorAtIndex:(NSUInteger)index withPointer:(const void *)pointer {
+    [self dispatchSelectorAtIndex:index withPointer:pointer audience:GrowingULDelegateAudienceAll];
+}
+
+- (void)dispatchSelectorAtIndex:(NSUInteger)index withPointer:(const void *)pointer audience:(uint64_t)audience {
+    NSParameterAssert(index < _selectorCount);
+    atomic_fetch_add(&_readers, 1);
+    __unsafe_unretained GrowingULDelegateSnapshot *snapshot =
+        (__bridge GrowingULDelegateSnapshot *)atomic_load(&_snapshot);
+    GrowingULDelegateList list = snapshot->_lists[index];
+    SEL selector = _selectors[index];
+    BOOL timed = atomic_load_explicit(&_latencyInstrumentation, memory_order_relaxed);
+    for (NSUInteger i = 0; i < list.count; i++) {
+        if (!(list.entries[i].audience & audience)) {
+            continue;
+        }
+        GrowingULDelegateCall call;
+        if (!GrowingULDelegateCallBegin(&list.entries[i], selector, &call)) {
+            continue;
+        }
+        uint64_t start = timed ? GrowingULMonotonicTimeNanos() : 0;
+        ((void (*)(id, SEL, const void *))call.imp)(call.target, selector, pointer);
+        if (timed) {
+            GrowingULLatencyHistogramRecord(list.entries[i].histogram, GrowingULMonotonicTimeNanos() - start);
+        }
+        GrowingULDelegateCallEnd(&call);
+    }
+    GrowingULDelegateRegistryEndReading(self);
+}
+
+@end
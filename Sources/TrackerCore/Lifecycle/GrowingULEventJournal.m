@@ -0,0 +1,360 @@
+//
+//  GrowingULEventJournal.m
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingULEventJournal.h"
+#import "GrowingULClassTable.h"
+#import "GrowingULTimeUtil.h"
+#import <fcntl.h>
+#import <os/lock.h>
+#import <sched.h>
+#import <stdatomic.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <unistd.h>
+
+static const uint32_t GrowingULJournalMagic = 0x4A4C5547;  // "GULJ"
+static const uint16_t GrowingULJournalVersion = 1;
+static const size_t GrowingULJournalHeaderSize = 4096;
+static const size_t GrowingULJournalClassSectionSize = 64 * 1024;
+static const NSUInteger GrowingULJournalDefaultCapacity = 4096;
+
+// set in a record's sequence, with the writer's own sequence, while the writer fills the record
+static const uint64_t GrowingULJournalRecordWriting = 1ULL << 63;
+
+_Static_assert(sizeof(GrowingULJournalRecord) == 32, "journal records are 32 bytes on disk");
+
+// first bytes of the file; the rest of its page is unused
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t capacity;
+    uint32_t classSectionSize;
+    // sequence of the next record to append
+    _Atomic uint64_t nextSequence;
+    // bytes of the class section holding complete entries
+    _Atomic uint32_t classSectionLength;
+} GrowingULJournalHeader;
+
+// class section entry, followed by length bytes of UTF-8 padded to 4 bytes
+typedef struct {
+    uint32_t classId;
+    uint32_t length;
+} GrowingULJournalClassEntry;
+
+@implementation GrowingULEventJournal {
+    void *_base;
+    size_t _length;
+    GrowingULJournalHeader *_header;
+    uint8_t *_classSection;
+    GrowingULJournalRecord *_records;
+    // sequence of the first record appended by this process
+    uint64_t _recoveredEnd;
+    os_unfair_lock _classLock;
+    // guarded by _classLock; journal class id by GrowingULClassId - 1, 0 until interned, UINT32_MAX if not stored
+    uint32_t *_journalClassIds;
+    NSUInteger _journalClassIdCapacity;
+    // guarded by _classLock; ids are increasing but not contiguous once the section has been compacted
+    NSMutableDictionary<NSNumber *, NSString *> *_classNamesById;
+    NSMutableDictionary<NSString *, NSNumber *> *_classIdsByName;
+    uint32_t _nextClassId;
+}
+
++ (instancetype)defaultJournal {
+    static GrowingULEventJournal *_defaultJournal = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSString *support =
+            NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES).firstObject;
+        NSString *directory = [support stringByAppendingPathComponent:@"GrowingUL"];
+        [[NSFileManager defaultManager] createDirectoryAtPath:directory
+                                  withIntermediateDirectories:YES
+                                                   attributes:nil
+                                                        error:nil];
+        _defaultJournal = [[self alloc] initWithPath:[directory stringByAppendingPathComponent:@"lifecycle.journal"]
+                                            capacity:GrowingULJournalDefaultCapacity
+                                               error:nil];
+    });
+
+    return _defaultJournal;
+}
+
+static NSError *GrowingULJournalPOSIXError(NSString *path) {
+    return [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{NSFilePathErrorKey : path}];
+}
+
+- (instancetype)initWithPath:(NSString *)path capacity:(NSUInteger)capacity error:(NSError **)error {
+    NSParameterAssert(capacity > 0 && capacity <= UINT32_MAX);
+    self = [super init];
+    if (self) {
+        _path = [path copy];
+        _capacity = capacity;
+        _length = GrowingULJournalHeaderSize + GrowingULJournalClassSectionSize +
+                  capacity * sizeof(GrowingULJournalRecord);
+
+        int fd = open(path.fileSystemRepresentation, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            if (error) {
+                *error = GrowingULJournalPOSIXError(path);
+            }
+            return nil;
+        }
+        struct stat status;
+        BOOL reset = fstat(fd, &status) != 0 || (size_t)status.st_size != _length;
+        if (reset && ftruncate(fd, (off_t)_length) != 0) {
+            if (error) {
+                *error = GrowingULJournalPOSIXError(path);
+            }
+            close(fd);
+            return nil;
+        }
+        void *base = mmap(NULL, _length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        // the mapping keeps the file referenced
+        close(fd);
+        if (base == MAP_FAILED) {
+            if (error) {
+                *error = GrowingULJournalPOSIXError(path);
+            }
+            return nil;
+        }
+
+        _base = base;
+        _header = base;
+        _classSection = (uint8_t *)base + GrowingULJournalHeaderSize;
+        _records = (GrowingULJournalRecord *)(_classSection + GrowingULJournalClassSectionSize);
+        if (reset || _header->magic != GrowingULJournalMagic || _header->version != GrowingULJournalVersion ||
+            _header->recordSize != sizeof(GrowingULJournalRecord) || _header->capacity != capacity ||
+            _header->classSectionSize != GrowingULJournalClassSectionSize) {
+            memset(base, 0, _length);
+            _header->magic = GrowingULJournalMagic;
+            _header->version = GrowingULJournalVersion;
+            _header->recordSize = sizeof(GrowingULJournalRecord);
+            _header->capacity = (uint32_t)capacity;
+            _header->classSectionSize = GrowingULJournalClassSectionSize;
+            atomic_store(&_header->nextSequence, 1);
+        }
+
+        _classLock = OS_UNFAIR_LOCK_INIT;
+        _recoveredEnd = atomic_load(&_header->nextSequence);
+        [self loadClassSection];
+        [self compactClassSection];
+
+        [self appendRecordWithType:GrowingULJournalRecordTypeSessionStart
+                         timestamp:[GrowingULTimeUtil currentSystemTimeMillis]
+                        instanceId:GrowingULWallTimeNanos() / NSEC_PER_MSEC
+                           classId:(uint32_t)getpid()];
+    }
+
+    return self;
+}
+
+- (void)dealloc {
+    if (_base) {
+        munmap(_base, _length);
+    }
+    free(_journalClassIds);
+}
+
+- (void)loadClassSection {
+    _classNamesById = [NSMutableDictionary dictionary];
+    _classIdsByName = [NSMutableDictionary dictionary];
+    _nextClassId = 1;
+    size_t length = MIN(atomic_load(&_header->classSectionLength), GrowingULJournalClassSectionSize);
+    size_t offset = 0;
+    while (offset + sizeof(GrowingULJournalClassEntry) <= length) {
+        GrowingULJournalClassEntry entry;
+        memcpy(&entry, _classSection + offset, sizeof(entry));
+        size_t end = offset + sizeof(entry) + entry.length;
+        if (entry.classId < _nextClassId || entry.classId == UINT32_MAX || end > length) {
+            break;
+        }
+        NSString *name = [[NSString alloc] initWithBytes:_classSection + offset + sizeof(entry)
+                                                  length:entry.length
+                                                encoding:NSUTF8StringEncoding];
+        if (!name) {
+            break;
+        }
+        _classNamesById[@(entry.classId)] = name;
+        _classIdsByName[name] = @(entry.classId);
+        _nextClassId = entry.classId + 1;
+        offset = (end + 3) & ~(size_t)3;
+    }
+    // drops whatever follows an entry that did not validate
+    atomic_store(&_header->classSectionLength, (uint32_t)MIN(offset, length));
+}
+
+// The section is append-only within a session; at open, once it is more than half full, it keeps only the names the
+// recovered records refer to. Entries keep their ids, so no record is rewritten.
+- (void)compactClassSection {
+    NSMutableIndexSet *referenced = [NSMutableIndexSet indexSet];
+    [self enumerateRecoveredRecordsUsingBlock:^(const GrowingULJournalRecord *record, BOOL *stop) {
+        if (record->type != GrowingULJournalRecordTypeSessionStart && record->classId != 0) {
+            [referenced addIndex:record->classId];
+        }
+    }];
+    // ids of names lost to a crash during a compaction are not handed out again
+    if (referenced.count > 0 && referenced.lastIndex >= _nextClassId) {
+        _nextClassId = (uint32_t)MIN(referenced.lastIndex + 1, UINT32_MAX);
+    }
+    size_t length = atomic_load(&_header->classSectionLength);
+    if (length <= GrowingULJournalClassSectionSize / 2) {
+        return;
+    }
+
+    // a crash while entries move loses the names of the recovered records, never maps an id to another name
+    atomic_store(&_header->classSectionLength, 0);
+    size_t offset = 0;
+    size_t compacted = 0;
+    while (offset < length) {
+        GrowingULJournalClassEntry entry;
+        memcpy(&entry, _classSection + offset, sizeof(entry));
+        size_t size = (sizeof(entry) + entry.length + 3) & ~(size_t)3;
+        if ([referenced containsIndex:entry.classId]) {
+            memmove(_classSection + compacted, _classSection + offset, size);
+            compacted += size;
+        }
+        offset += size;
+    }
+    atomic_store(&_header->classSectionLength, (uint32_t)compacted);
+
+    uint32_t nextClassId = _nextClassId;
+    [self loadClassSection];
+    _nextClassId = nextClassId;
+}
+
+- (void)appendEvent:(const GrowingULLifecycleEvent *)event {
+    GrowingULClassId classId = event->classId ?: GrowingULClassIdForClass(event->objectClass);
+    [self appendRecordWithType:event->type
+                     timestamp:event->timestamp
+                    instanceId:(uint64_t)(uintptr_t)event->objectIdentity
+                       classId:[self journalClassIdForClassId:classId]];
+}
+
+- (void)appendRecordWithType:(GrowingULLifecycleEventType)type
+                   timestamp:(double)timestamp
+                  instanceId:(uint64_t)instanceId
+                     classId:(uint32_t)classId {
+    uint64_t sequence = atomic_fetch_add_explicit(&_header->nextSequence, 1, memory_order_relaxed);
+    GrowingULJournalRecord *record = &_records[(sequence - 1) % _capacity];
+    // A writer that has lapped the ring may target the slot a slower one is still filling: the slot is claimed with
+    // a CAS on its sequence, so two writers never fill it at once. A record torn by a crash keeps the marked sequence
+    // and is skipped by readers.
+    uint64_t current = __atomic_load_n(&record->sequence, __ATOMIC_RELAXED);
+    for (;;) {
+        uint64_t owner = current & ~GrowingULJournalRecordWriting;
+        if (owner >= sequence) {
+            // a newer record is stored or being stored in the slot, it would have overwritten this one
+            return;
+        }
+        if ((current & GrowingULJournalRecordWriting) && owner >= _recoveredEnd) {
+            // an older writer of this process is still filling the slot; marks left by a crash are taken over
+            sched_yield();
+            current = __atomic_load_n(&record->sequence, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&record->sequence, &current, sequence | GrowingULJournalRecordWriting, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+    atomic_thread_fence(memory_order_release);
+    record->timestamp = timestamp;
+    record->instanceId = instanceId;
+    record->classId = classId;
+    record->type = type;
+    record->reserved = 0;
+    __atomic_store_n(&record->sequence, sequence, __ATOMIC_RELEASE);
+}
+
+- (uint32_t)journalClassIdForClassId:(GrowingULClassId)classId {
+    if (classId == 0) {
+        return 0;
+    }
+    os_unfair_lock_lock(&_classLock);
+    if (classId > _journalClassIdCapacity) {
+        NSUInteger capacity = MAX(_journalClassIdCapacity * 2, MAX((NSUInteger)classId, 64));
+        _journalClassIds = realloc(_journalClassIds, capacity * sizeof(uint32_t));
+        memset(_journalClassIds + _journalClassIdCapacity, 0, (capacity - _journalClassIdCapacity) * sizeof(uint32_t));
+        _journalClassIdCapacity = capacity;
+    }
+    uint32_t *stored = &_journalClassIds[classId - 1];
+    if (*stored == 0) {
+        uint32_t journalClassId = [self internClassNameLocked:GrowingULClassNameForId(classId)];
+        *stored = journalClassId ?: UINT32_MAX;
+    }
+    uint32_t journalClassId = *stored == UINT32_MAX ? 0 : *stored;
+    os_unfair_lock_unlock(&_classLock);
+    return journalClassId;
+}
+
+// returns 0 when the class section is full
+- (uint32_t)internClassNameLocked:(NSString *)name {
+    NSNumber *known = _classIdsByName[name];
+    if (known) {
+        return known.unsignedIntValue;
+    }
+    const char *bytes = name.UTF8String;
+    GrowingULJournalClassEntry entry = {
+        .classId = _nextClassId,
+        .length = (uint32_t)strlen(bytes),
+    };
+    size_t offset = atomic_load_explicit(&_header->classSectionLength, memory_order_relaxed);
+    size_t end = (offset + sizeof(entry) + entry.length + 3) & ~(size_t)3;
+    if (end > GrowingULJournalClassSectionSize || entry.classId == UINT32_MAX) {
+        return 0;
+    }
+    memcpy(_classSection + offset, &entry, sizeof(entry));
+    memcpy(_classSection + offset + sizeof(entry), bytes, entry.length);
+    atomic_store_explicit(&_header->classSectionLength, (uint32_t)end, memory_order_release);
+    _classNamesById[@(entry.classId)] = name;
+    _classIdsByName[name] = @(entry.classId);
+    _nextClassId++;
+    return entry.classId;
+}
+
+- (nullable NSString *)classNameForId:(uint32_t)classId {
+    os_unfair_lock_lock(&_classLock);
+    NSString *name = _classNamesById[@(classId)];
+    os_unfair_lock_unlock(&_classLock);
+    return name;
+}
+
+- (void)enumerateRecoveredRecordsUsingBlock:(void (NS_NOESCAPE ^)(const GrowingULJournalRecord *record,
+                                                                  BOOL *stop))block {
+    uint64_t end = _recoveredEnd;
+    uint64_t start = end > _capacity ? end - _capacity : 1;
+    BOOL stop = NO;
+    for (uint64_t sequence = start; sequence < end && !stop; sequence++) {
+        GrowingULJournalRecord *slot = &_records[(sequence - 1) % _capacity];
+        // slots are overwritten once this process has appended a full ring; a changed sequence means the copy is
+        // not the recovered record
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != sequence) {
+            continue;
+        }
+        GrowingULJournalRecord record = *slot;
+        atomic_thread_fence(memory_order_acquire);
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) != sequence) {
+            continue;
+        }
+        record.sequence = sequence;
+        block(&record, &stop);
+    }
+}
+
+@end
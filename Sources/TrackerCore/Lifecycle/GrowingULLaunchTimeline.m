@@ -0,0 +1,177 @@
+//
+//  GrowingULLaunchTimeline.m
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingULLaunchTimeline.h"
+#import "GrowingULAppLifecycle.h"
+#import "GrowingULTimeUtil.h"
+#import <TargetConditionals.h>
+#import <os/lock.h>
+#import <stdatomic.h>
+#if TARGET_OS_MAC
+#import <sys/sysctl.h>
+#endif
+
+@interface GrowingULAppLifecycle (GrowingULLaunchTimeline)
+
+- (void)dispatchApplicationDidCompleteLaunch:(const GrowingULLaunchTimeline *)timeline;
+
+@end
+
+static os_unfair_lock growingul_launchLock = OS_UNFAIR_LOCK_INIT;
+// guarded by growingul_launchLock
+static GrowingULLaunchTimeline growingul_launchTimeline;
+static BOOL growingul_launchExpectsPage;
+static BOOL growingul_launchCompleted;
+// read without the lock on every viewDidAppear:
+static atomic_bool growingul_launchPageRecorded;
+
+static NSString *const GrowingULLaunchBootTimeKey = @"growingul.launch.bootTime";
+static NSString *const GrowingULLaunchVersionKey = @"growingul.launch.version";
+
+// seconds since 1970, 0 if unavailable
+static double GrowingULProcessStartWallTime(void) {
+#if TARGET_OS_MAC
+    int mib[4] = {CTL_KERN, KERN_PROC, KERN_PROC_PID, getpid()};
+    struct kinfo_proc info;
+    size_t size = sizeof(info);
+    if (sysctl(mib, 4, &info, &size, NULL, 0) == 0) {
+        return info.kp_proc.p_starttime.tv_sec + info.kp_proc.p_starttime.tv_usec / (double)USEC_PER_SEC;
+    }
+#endif
+    return 0;
+}
+
+static double GrowingULBootWallTime(void) {
+#if TARGET_OS_MAC
+    int mib[2] = {CTL_KERN, KERN_BOOTTIME};
+    struct timeval boot;
+    size_t size = sizeof(boot);
+    if (sysctl(mib, 2, &boot, &size, NULL, 0) == 0) {
+        return boot.tv_sec + boot.tv_usec / (double)USEC_PER_SEC;
+    }
+#endif
+    return 0;
+}
+
+// Runs before main, after the images this library links against are initialized. No Objective-C messaging.
+__attribute__((constructor)) static void GrowingULLaunchTimelineInitialize(void) {
+    growingul_launchTimeline.initializerTime = (double)GrowingULMonotonicTimeNanos() / NSEC_PER_MSEC;
+    double start = GrowingULProcessStartWallTime();
+    if (start > 0) {
+        double now = (double)GrowingULWallTimeNanos() / NSEC_PER_SEC;
+        growingul_launchTimeline.processStartTime =
+            MAX(growingul_launchTimeline.initializerTime - (now - start) * 1000, 0);
+    }
+    const char *prewarm = getenv("ActivePrewarm");
+    if (prewarm && strcmp(prewarm, "1") == 0) {
+        growingul_launchTimeline.type = GrowingULLaunchTypePrewarmed;
+    }
+}
+
+// Cold unless this app version already launched since the device booted; remembered in the user defaults.
+static GrowingULLaunchType GrowingULClassifyLaunch(void) {
+    double bootTime = GrowingULBootWallTime();
+    if (bootTime <= 0) {
+        return GrowingULLaunchTypeUnknown;
+    }
+    NSDictionary *info = NSBundle.mainBundle.infoDictionary;
+    NSString *version =
+        [NSString stringWithFormat:@"%@ (%@)", info[@"CFBundleShortVersionString"], info[@"CFBundleVersion"]];
+    NSUserDefaults *defaults = NSUserDefaults.standardUserDefaults;
+    // boot times read in different launches may differ in the sub-second part
+    BOOL sameBoot = fabs([defaults doubleForKey:GrowingULLaunchBootTimeKey] - bootTime) < 1;
+    BOOL sameVersion = [[defaults stringForKey:GrowingULLaunchVersionKey] isEqualToString:version];
+    [defaults setDouble:bootTime forKey:GrowingULLaunchBootTimeKey];
+    [defaults setObject:version forKey:GrowingULLaunchVersionKey];
+    return sameBoot && sameVersion ? GrowingULLaunchTypeWarm : GrowingULLaunchTypeCold;
+}
+
+BOOL GrowingULCurrentLaunchTimeline(GrowingULLaunchTimeline *timeline) {
+    os_unfair_lock_lock(&growingul_launchLock);
+    *timeline = growingul_launchTimeline;
+    BOOL completed = growingul_launchCompleted;
+    os_unfair_lock_unlock(&growingul_launchLock);
+    return completed;
+}
+
+// Called with the lock held; completes the timeline at most once.
+static BOOL GrowingULLaunchTimelineCompleteLocked(void) {
+    if (growingul_launchCompleted || growingul_launchTimeline.didBecomeActiveTime == 0) {
+        return NO;
+    }
+    if (growingul_launchExpectsPage && growingul_launchTimeline.firstPageAppearTime == 0) {
+        return NO;
+    }
+    growingul_launchCompleted = YES;
+    return YES;
+}
+
+static void GrowingULLaunchTimelineRecord(double *milestone, double time) {
+    os_unfair_lock_lock(&growingul_launchLock);
+    if (*milestone == 0) {
+        *milestone = time;
+    }
+    BOOL completed = GrowingULLaunchTimelineCompleteLocked();
+    GrowingULLaunchType type = growingul_launchTimeline.type;
+    os_unfair_lock_unlock(&growingul_launchLock);
+    if (!completed) {
+        return;
+    }
+
+    // classified outside of the lock, it reads the user defaults; a background launch does not count as a launch of
+    // this version in this boot session either
+    if (type != GrowingULLaunchTypePrewarmed && type != GrowingULLaunchTypeBackground) {
+        type = GrowingULClassifyLaunch();
+    }
+    os_unfair_lock_lock(&growingul_launchLock);
+    growingul_launchTimeline.type = type;
+    GrowingULLaunchTimeline timeline = growingul_launchTimeline;
+    os_unfair_lock_unlock(&growingul_launchLock);
+    [[GrowingULAppLifecycle sharedInstance] dispatchApplicationDidCompleteLaunch:&timeline];
+}
+
+void GrowingULLaunchTimelineExpectPageAppearance(void) {
+    os_unfair_lock_lock(&growingul_launchLock);
+    growingul_launchExpectsPage = YES;
+    os_unfair_lock_unlock(&growingul_launchLock);
+}
+
+void GrowingULLaunchTimelineRecordDidFinishLaunching(double time) {
+    GrowingULLaunchTimelineRecord(&growingul_launchTimeline.didFinishLaunchingTime, time);
+}
+
+void GrowingULLaunchTimelineRecordDidBecomeActive(double time) {
+    GrowingULLaunchTimelineRecord(&growingul_launchTimeline.didBecomeActiveTime, time);
+}
+
+void GrowingULLaunchTimelineMarkBackgroundLaunch(void) {
+    os_unfair_lock_lock(&growingul_launchLock);
+    if (!growingul_launchCompleted && growingul_launchTimeline.type == GrowingULLaunchTypeUnknown) {
+        growingul_launchTimeline.type = GrowingULLaunchTypeBackground;
+    }
+    os_unfair_lock_unlock(&growingul_launchLock);
+}
+
+void GrowingULLaunchTimelineRecordPageAppearance(double time) {
+    if (atomic_load_explicit(&growingul_launchPageRecorded, memory_order_relaxed)) {
+        return;
+    }
+    atomic_store_explicit(&growingul_launchPageRecorded, true, memory_order_relaxed);
+    GrowingULLaunchTimelineRecord(&growingul_launchTimeline.firstPageAppearTime, time);
+}
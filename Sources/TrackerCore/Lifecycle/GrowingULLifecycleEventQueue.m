@@ -0,0 +1,129 @@
+//
+//  GrowingULLifecycleEventQueue.m
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingULLifecycleEventQueue.h"
+#import <stdatomic.h>
+
+typedef struct {
+    // position + 1 once the event for position is published, position + capacity once it has been consumed
+    atomic_uint_fast64_t sequence;
+    GrowingULLifecycleEvent event;
+} GrowingULLifecycleEventSlot;
+
+@implementation GrowingULLifecycleEventQueue {
+    GrowingULLifecycleEventSlot *_slots;
+    uint64_t _mask;
+    dispatch_queue_t _queue;
+    GrowingULLifecycleEventHandler _handler;
+    // next position to claim, advanced by producers with a CAS
+    atomic_uint_fast64_t _head;
+    // written by the consumer only
+    uint64_t _tail;
+    atomic_bool _drainScheduled;
+    atomic_ulong _droppedEventCount;
+}
+
+- (instancetype)initWithLabel:(const char *)label
+                     capacity:(NSUInteger)capacity
+                      handler:(GrowingULLifecycleEventHandler)handler {
+    self = [super init];
+    if (self) {
+        uint64_t size = 1;
+        while (size < MAX(capacity, 2)) {
+            size <<= 1;
+        }
+        _slots = calloc(size, sizeof(GrowingULLifecycleEventSlot));
+        for (uint64_t i = 0; i < size; i++) {
+            atomic_init(&_slots[i].sequence, i);
+        }
+        _mask = size - 1;
+        _queue = dispatch_queue_create(label, DISPATCH_QUEUE_SERIAL);
+        _handler = [handler copy];
+        atomic_init(&_head, 0);
+        _tail = 0;
+        atomic_init(&_drainScheduled, false);
+        atomic_init(&_droppedEventCount, 0);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_slots);
+}
+
+- (NSUInteger)droppedEventCount {
+    return atomic_load_explicit(&_droppedEventCount, memory_order_relaxed);
+}
+
+- (void)enqueueEvent:(GrowingULLifecycleEvent)event {
+    // Every producer claims its position with a CAS on _head: the ring order is the order events were observed in,
+    // whichever thread observed them.
+    uint64_t head = atomic_load_explicit(&_head, memory_order_relaxed);
+    GrowingULLifecycleEventSlot *slot = NULL;
+    for (;;) {
+        slot = &_slots[head & _mask];
+        uint64_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int64_t distance = (int64_t)(sequence - head);
+        if (distance == 0) {
+            if (atomic_compare_exchange_weak_explicit(&_head, &head, head + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (distance < 0) {
+            // the consumer has not freed the slot a lap ago
+            slot = NULL;
+            break;
+        } else {
+            head = atomic_load_explicit(&_head, memory_order_relaxed);
+        }
+    }
+
+    if (slot) {
+        slot->event = event;
+        atomic_store_explicit(&slot->sequence, head + 1, memory_order_release);
+    } else {
+        atomic_fetch_add_explicit(&_droppedEventCount, 1, memory_order_relaxed);
+    }
+
+    if (!atomic_exchange(&_drainScheduled, true)) {
+        dispatch_async(_queue, ^{
+            [self drain];
+        });
+    }
+}
+
+- (void)drain {
+    // Clear the flag before reading the ring: anything published after this point schedules another drain. A slot
+    // claimed but not yet published stops the drain; its producer schedules the next one.
+    atomic_store(&_drainScheduled, false);
+    uint64_t tail = _tail;
+    for (;;) {
+        GrowingULLifecycleEventSlot *slot = &_slots[tail & _mask];
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != tail + 1) {
+            break;
+        }
+        GrowingULLifecycleEvent event = slot->event;
+        atomic_store_explicit(&slot->sequence, tail + _mask + 1, memory_order_release);
+        tail++;
+        _tail = tail;
+        _handler(event);
+    }
+}
+
+@end
@@ -0,0 +1,128 @@
+//
+//  GrowingULSceneStateAggregator.m
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingULSceneStateAggregator.h"
+#import "GrowingULPointerMap.h"
+
+#define GrowingULSceneActivationStateCount 4
+
+static const GrowingULSceneActivationState GrowingULSceneTransitionTargets[] = {
+    [GrowingULSceneTransitionWillConnect] = GrowingULSceneActivationStateBackground,
+    [GrowingULSceneTransitionWillEnterForeground] = GrowingULSceneActivationStateForegroundInactive,
+    [GrowingULSceneTransitionDidActivate] = GrowingULSceneActivationStateForegroundActive,
+    [GrowingULSceneTransitionWillDeactivate] = GrowingULSceneActivationStateForegroundInactive,
+    [GrowingULSceneTransitionDidEnterBackground] = GrowingULSceneActivationStateBackground,
+    [GrowingULSceneTransitionDidDisconnect] = GrowingULSceneActivationStateUnattached,
+};
+
+// application event of the aggregate stepping up from, or down from, a state
+static const GrowingULLifecycleEventType GrowingULSceneStepUpEvents[GrowingULSceneActivationStateCount] = {
+    [GrowingULSceneActivationStateBackground] = GrowingULLifecycleEventTypeApplicationWillEnterForeground,
+    [GrowingULSceneActivationStateForegroundInactive] = GrowingULLifecycleEventTypeApplicationDidBecomeActive,
+};
+static const GrowingULLifecycleEventType GrowingULSceneStepDownEvents[GrowingULSceneActivationStateCount] = {
+    [GrowingULSceneActivationStateForegroundActive] = GrowingULLifecycleEventTypeApplicationWillResignActive,
+    [GrowingULSceneActivationStateForegroundInactive] = GrowingULLifecycleEventTypeApplicationDidEnterBackground,
+};
+
+@implementation GrowingULSceneStateAggregator {
+    // scene -> GrowingULSceneActivationState, connected scenes only
+    GrowingULPointerMap *_states;
+    NSUInteger _counts[GrowingULSceneActivationStateCount];
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _states = GrowingULPointerMapCreate(sizeof(GrowingULSceneActivationState));
+        _applicationState = GrowingULSceneActivationStateBackground;
+    }
+
+    return self;
+}
+
+- (void)dealloc {
+    GrowingULPointerMapDestroy(_states);
+}
+
+- (NSUInteger)sceneCount {
+    return GrowingULPointerMapCount(_states);
+}
+
+- (GrowingULSceneActivationState)stateOfScene:(const void *)scene {
+    GrowingULSceneActivationState *state = GrowingULPointerMapGet(_states, scene);
+    return state ? *state : GrowingULSceneActivationStateUnattached;
+}
+
+- (NSUInteger)applyTransition:(GrowingULSceneTransition)transition
+                      toScene:(const void *)scene
+                previousState:(GrowingULSceneActivationState *)previousState
+                       events:(GrowingULLifecycleEventType *)events {
+    GrowingULSceneActivationState target = GrowingULSceneTransitionTargets[transition];
+    GrowingULSceneActivationState previous = GrowingULSceneActivationStateUnattached;
+    if (target == GrowingULSceneActivationStateUnattached) {
+        GrowingULSceneActivationState *stored = GrowingULPointerMapGet(_states, scene);
+        if (stored) {
+            previous = *stored;
+            GrowingULPointerMapRemove(_states, scene);
+        }
+    } else {
+        GrowingULSceneActivationState *stored = GrowingULPointerMapGetOrInsert(_states, scene, NULL);
+        previous = *stored;
+        *stored = target;
+        _counts[target]++;
+    }
+    if (previous != GrowingULSceneActivationStateUnattached) {
+        _counts[previous]--;
+    }
+    if (previousState) {
+        *previousState = previous;
+    }
+
+    GrowingULSceneActivationState aggregate = [self aggregateState];
+    NSUInteger count = 0;
+    // a scene may skip a step, e.g. when disconnecting while active; every step in between is reported
+    for (GrowingULSceneActivationState state = _applicationState; state < aggregate; state++) {
+        events[count++] = GrowingULSceneStepUpEvents[state];
+    }
+    for (GrowingULSceneActivationState state = _applicationState; state > aggregate; state--) {
+        events[count++] = GrowingULSceneStepDownEvents[state];
+    }
+    _applicationState = aggregate;
+    return count;
+}
+
+- (void)seedScene:(const void *)scene state:(GrowingULSceneActivationState)state {
+    if (state == GrowingULSceneActivationStateUnattached || GrowingULPointerMapGet(_states, scene)) {
+        return;
+    }
+    *(GrowingULSceneActivationState *)GrowingULPointerMapGetOrInsert(_states, scene, NULL) = state;
+    _counts[state]++;
+    _applicationState = [self aggregateState];
+}
+
+- (GrowingULSceneActivationState)aggregateState {
+    return _counts[GrowingULSceneActivationStateForegroundActive] > 0
+               ? GrowingULSceneActivationStateForegroundActive
+           : _counts[GrowingULSceneActivationStateForegroundInactive] > 0
+               ? GrowingULSceneActivationStateForegroundInactive
+               : GrowingULSceneActivationStateBackground;
+}
+
+@end
@@ -0,0 +1,302 @@
+//
+//  GrowingULStallMonitor.m
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+
+#import "GrowingULStallMonitor.h"
+#import "GrowingULTimeUtil.h"
+#import <TargetConditionals.h>
+#import <os/lock.h>
+#import <stdatomic.h>
+
+static const uint64_t GrowingULStallSamplesPerThreshold = 4;
+// bit of the activity word set while the main run loop is waiting for work
+static const uint64_t GrowingULStallActivityWaiting = 1;
+
+@implementation GrowingULStallMonitor {
+    // iteration counter (in steps of 2) | GrowingULStallActivityWaiting, written by the observer only
+    atomic_uint_fast64_t _activity;
+    // main thread only
+    uint64_t _iterations;
+    atomic_uint_fast32_t _pageClassId;
+    // type << 32 | classId of the last event recorded
+    atomic_uint_fast64_t _lastEvent;
+    atomic_bool _running;
+
+    dispatch_queue_t _queue;
+#if TARGET_OS_MAC
+    // main thread only
+    CFRunLoopObserverRef _observer;
+#endif
+    // _queue only
+    dispatch_source_t _timer;
+    uint64_t _intervalNanos;
+    uint64_t _thresholdNanos[GrowingULStallMaxThresholds];
+    NSUInteger _thresholdCount;
+    uint64_t _sampledActivity;
+    // first sample of the current iteration, moved forward by the time the sampler could not run
+    uint64_t _sampledSinceNanos;
+    uint64_t _lastSampleNanos;
+    BOOL _stalled;
+    GrowingULStall _stall;
+
+    os_unfair_lock _histogramLock;
+    // indexed by page class id and grown on _queue; histograms are never freed while the monitor lives
+    GrowingULLatencyHistogram **_histograms;
+    NSUInteger _histogramCapacity;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _thresholds = @[@0.25];
+        _queue = dispatch_queue_create("com.growingio.utils.stallmonitor", DISPATCH_QUEUE_SERIAL);
+        _histogramLock = OS_UNFAIR_LOCK_INIT;
+        atomic_init(&_activity, 0);
+        atomic_init(&_pageClassId, 0);
+        atomic_init(&_lastEvent, 0);
+        atomic_init(&_running, false);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i < _histogramCapacity; i++) {
+        if (_histograms[i]) {
+            GrowingULLatencyHistogramDestroy(_histograms[i]);
+        }
+    }
+    free(_histograms);
+}
+
+- (void)setThresholds:(NSArray<NSNumber *> *)thresholds {
+    NSMutableOrderedSet<NSNumber *> *seconds = [NSMutableOrderedSet orderedSet];
+    for (NSNumber *threshold in thresholds) {
+        [seconds addObject:@(MAX(threshold.doubleValue, 0.01))];
+    }
+    _thresholds = seconds.count > 0 ? [seconds.array sortedArrayUsingSelector:@selector(compare:)] : @[@0.25];
+}
+
+- (BOOL)isRunning {
+    return atomic_load_explicit(&_running, memory_order_relaxed);
+}
+
+#if TARGET_OS_MAC
+static void GrowingULStallMonitorObserve(CFRunLoopObserverRef observer, CFRunLoopActivity activity, void *info) {
+    __unsafe_unretained GrowingULStallMonitor *monitor = (__bridge GrowingULStallMonitor *)info;
+    monitor->_iterations += 2;
+    uint64_t waiting = activity == kCFRunLoopBeforeWaiting ? GrowingULStallActivityWaiting : 0;
+    atomic_store_explicit(&monitor->_activity, monitor->_iterations | waiting, memory_order_relaxed);
+}
+#endif
+
+- (void)start {
+#if TARGET_OS_MAC
+    if (atomic_exchange(&_running, true)) {
+        return;
+    }
+    NSArray<NSNumber *> *thresholds = self.thresholds;
+    [self updateObserver];
+
+    __weak GrowingULStallMonitor *weakSelf = self;
+    dispatch_async(_queue, ^{
+        self->_thresholdCount = MIN(thresholds.count, GrowingULStallMaxThresholds);
+        for (NSUInteger i = 0; i < self->_thresholdCount; i++) {
+            self->_thresholdNanos[i] = (uint64_t)(thresholds[i].doubleValue * NSEC_PER_SEC);
+        }
+        self->_intervalNanos = self->_thresholdNanos[0] / GrowingULStallSamplesPerThreshold;
+        self->_sampledActivity = atomic_load_explicit(&self->_activity, memory_order_relaxed);
+        self->_sampledSinceNanos = GrowingULMonotonicTimeNanos();
+        self->_lastSampleNanos = self->_sampledSinceNanos;
+        self->_stalled = NO;
+        self->_timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self->_queue);
+        dispatch_source_set_timer(self->_timer,
+                                  dispatch_time(DISPATCH_TIME_NOW, (int64_t)self->_intervalNanos),
+                                  self->_intervalNanos,
+                                  self->_intervalNanos / 10);
+        dispatch_source_set_event_handler(self->_timer, ^{
+            [weakSelf sample];
+        });
+        dispatch_resume(self->_timer);
+    });
+#endif
+}
+
+- (void)stop {
+#if TARGET_OS_MAC
+    if (!atomic_exchange(&_running, false)) {
+        return;
+    }
+    dispatch_async(_queue, ^{
+        // a stall still running is dropped, it never ended
+        dispatch_source_cancel(self->_timer);
+        self->_timer = nil;
+        self->_stalled = NO;
+    });
+    [self updateObserver];
+#endif
+}
+
+#if TARGET_OS_MAC
+// Adds or removes the observer to match the running state. Start and stop may come from different threads, so an
+// observer added asynchronously may not exist yet when -stop runs on the main thread; every change of the running
+// state is followed by one of these passes on the main thread, and the last one leaves the right state.
+- (void)updateObserver {
+    if (!NSThread.isMainThread) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self updateObserver];
+        });
+        return;
+    }
+    BOOL running = atomic_load(&_running);
+    if (running && !_observer) {
+        // the run loop retains the monitor through the observer until -stop
+        CFRunLoopObserverContext context = {0, (__bridge void *)self, CFRetain, CFRelease, NULL};
+        _observer = CFRunLoopObserverCreate(kCFAllocatorDefault, kCFRunLoopAllActivities, true, 0,
+                                            GrowingULStallMonitorObserve, &context);
+        CFRunLoopAddObserver(CFRunLoopGetMain(), _observer, kCFRunLoopCommonModes);
+    } else if (!running && _observer) {
+        CFRunLoopRemoveObserver(CFRunLoopGetMain(), _observer, kCFRunLoopCommonModes);
+        CFRelease(_observer);
+        _observer = NULL;
+    }
+}
+#endif
+
+- (void)setPageClassId:(GrowingULClassId)pageClassId {
+    atomic_store_explicit(&_pageClassId, pageClassId, memory_order_relaxed);
+}
+
+- (void)recordEvent:(const GrowingULLifecycleEvent *)event {
+    atomic_store_explicit(&_lastEvent, (uint64_t)event->type << 32 | event->classId, memory_order_relaxed);
+}
+
+#pragma mark - Sampling
+
+- (void)sample {
+    uint64_t now = GrowingULMonotonicTimeNanos();
+    uint64_t activity = atomic_load_explicit(&_activity, memory_order_relaxed);
+    uint64_t elapsed = now - _lastSampleNanos;
+    _lastSampleNanos = now;
+    if (elapsed > 2 * _intervalNanos) {
+        // the sampler did not run, most likely the process was suspended; that time is not main thread work
+        _sampledSinceNanos += elapsed - _intervalNanos;
+    }
+
+    if (activity != _sampledActivity) {
+        if (_stalled) {
+            [self endStallAtNanos:now];
+        }
+        _sampledActivity = activity;
+        _sampledSinceNanos = now;
+        return;
+    }
+    if (activity & GrowingULStallActivityWaiting) {
+        return;
+    }
+    uint64_t duration = now - _sampledSinceNanos;
+    NSUInteger next = _stalled ? _stall.thresholdIndex + 1 : 0;
+    if (next >= _thresholdCount || duration < _thresholdNanos[next]) {
+        return;
+    }
+
+    if (!_stalled) {
+        uint64_t lastEvent = atomic_load_explicit(&_lastEvent, memory_order_relaxed);
+        _stalled = YES;
+        _stall = (GrowingULStall){
+            .startNanos = _sampledSinceNanos,
+            .pageClassId = (GrowingULClassId)atomic_load_explicit(&_pageClassId, memory_order_relaxed),
+            .lastEventType = (GrowingULLifecycleEventType)(lastEvent >> 32),
+            .lastEventClassId = (GrowingULClassId)lastEvent,
+        };
+    }
+    _stall.durationNanos = duration;
+    id<GrowingULStallMonitorDelegate> delegate = self.delegate;
+    BOOL notify = [delegate respondsToSelector:@selector(stallMonitor:didDetectStall:)];
+    // a late sample may cross several thresholds at once
+    for (; next < _thresholdCount && duration >= _thresholdNanos[next]; next++) {
+        _stall.thresholdIndex = (uint32_t)next;
+        _stall.thresholdNanos = _thresholdNanos[next];
+        if (notify) {
+            [delegate stallMonitor:self didDetectStall:&_stall];
+        }
+    }
+}
+
+- (void)endStallAtNanos:(uint64_t)now {
+    _stalled = NO;
+    _stall.durationNanos = now - _sampledSinceNanos;
+    GrowingULLatencyHistogramRecord([self histogramForPageClassId:_stall.pageClassId], _stall.durationNanos);
+    id<GrowingULStallMonitorDelegate> delegate = self.delegate;
+    if ([delegate respondsToSelector:@selector(stallMonitor:didEndStall:)]) {
+        [delegate stallMonitor:self didEndStall:&_stall];
+    }
+}
+
+#pragma mark - Histograms
+
+- (GrowingULLatencyHistogram *)histogramForPageClassId:(GrowingULClassId)pageClassId {
+    os_unfair_lock_lock(&_histogramLock);
+    if (pageClassId >= _histogramCapacity) {
+        NSUInteger capacity = MAX(_histogramCapacity, 64);
+        while (capacity <= pageClassId) {
+            capacity *= 2;
+        }
+        _histograms = realloc(_histograms, capacity * sizeof(GrowingULLatencyHistogram *));
+        for (NSUInteger i = _histogramCapacity; i < capacity; i++) {
+            _histograms[i] = NULL;
+        }
+        _histogramCapacity = capacity;
+    }
+    if (!_histograms[pageClassId]) {
+        _histograms[pageClassId] = GrowingULLatencyHistogramCreate();
+    }
+    GrowingULLatencyHistogram *histogram = _histograms[pageClassId];
+    os_unfair_lock_unlock(&_histogramLock);
+    return histogram;
+}
+
+- (GrowingULLatencySummary)stallSummaryForPageClassId:(GrowingULClassId)pageClassId {
+    GrowingULLatencySummary summary = {0};
+    os_unfair_lock_lock(&_histogramLock);
+    GrowingULLatencyHistogram *histogram = pageClassId < _histogramCapacity ? _histograms[pageClassId] : NULL;
+    os_unfair_lock_unlock(&_histogramLock);
+    if (histogram) {
+        summary = GrowingULLatencyHistogramSummarize(histogram);
+    }
+    return summary;
+}
+
+- (void)enumerateStallSummariesUsingBlock:(void (NS_NOESCAPE ^)(GrowingULClassId pageClassId,
+                                                                GrowingULLatencySummary summary))block {
+    os_unfair_lock_lock(&_histogramLock);
+    NSUInteger capacity = _histogramCapacity;
+    GrowingULLatencyHistogram **histograms = calloc(MAX(capacity, 1), sizeof(GrowingULLatencyHistogram *));
+    if (capacity) {
+        memcpy(histograms, _histograms, capacity * sizeof(GrowingULLatencyHistogram *));
+    }
+    os_unfair_lock_unlock(&_histogramLock);
+    for (NSUInteger i = 0; i < capacity; i++) {
+        if (histograms[i]) {
+            block((GrowingULClassId)i, GrowingULLatencyHistogramSummarize(histograms[i]));
+        }
+    }
+    free(histograms);
+}
+
+@end
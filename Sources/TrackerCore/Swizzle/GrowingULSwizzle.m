@@ -41,6 +41,7 @@
 //  limitations under the License.
 
 #import "GrowingULSwizzle.h"
+#import "GrowingULSwizzler.h"
 
 #if TARGET_OS_IPHONE
 #import <objc/runtime.h>
@@ -65,6 +66,72 @@
 #define GrowingGetClass(obj) (obj ? obj->isa : Nil)
 #endif
 
+BOOL GrowingULSwizzleMethods(GrowingULSwizzleEntry *entries, NSUInteger count, NSError **error) {
+    GrowingULSwizzleEntry *failed = NULL;
+    for (NSUInteger i = 0; i < count; i++) {
+        GrowingULSwizzleEntry *entry = &entries[i];
+        entry->result = GrowingULSwizzleEntryResultNotInstalled;
+        if (!class_getInstanceMethod(entry->cls, entry->originalSelector)) {
+            entry->result = GrowingULSwizzleEntryResultOriginalNotFound;
+        } else if (!class_getInstanceMethod(entry->cls, entry->replacementSelector)) {
+            entry->result = GrowingULSwizzleEntryResultReplacementNotFound;
+        } else {
+            for (NSUInteger j = 0; j < i; j++) {
+                if (entries[j].cls != entry->cls) {
+                    continue;
+                }
+                if (entries[j].originalSelector == entry->originalSelector ||
+                    entries[j].originalSelector == entry->replacementSelector ||
+                    entries[j].replacementSelector == entry->originalSelector ||
+                    entries[j].replacementSelector == entry->replacementSelector) {
+                    entry->result = GrowingULSwizzleEntryResultDuplicate;
+                    break;
+                }
+            }
+        }
+        if (entry->result != GrowingULSwizzleEntryResultNotInstalled && !failed) {
+            failed = entry;
+        }
+    }
+
+    if (failed) {
+        GrowingSetNSError(error,
+                          @"cannot swizzle %@ with %@ in class %@ (result %ld), no entry installed",
+                          NSStringFromSelector(failed->originalSelector),
+                          NSStringFromSelector(failed->replacementSelector),
+                          failed->cls,
+                          (long)failed->result);
+        return NO;
+    }
+
+    IMP *replacements = malloc(sizeof(IMP) * count);
+    IMP *originals = malloc(sizeof(IMP) * count);
+    for (NSUInteger i = 0; i < count; i++) {
+        Class cls = entries[i].cls;
+        Method origMethod = class_getInstanceMethod(cls, entries[i].originalSelector);
+        Method altMethod = class_getInstanceMethod(cls, entries[i].replacementSelector);
+        replacements[i] = method_getImplementation(altMethod);
+        originals[i] = method_getImplementation(origMethod);
+        // same steps as +growingul_swizzleMethod:withMethod:error:
+        class_addMethod(cls, entries[i].originalSelector, originals[i], method_getTypeEncoding(origMethod));
+        class_addMethod(cls, entries[i].replacementSelector, replacements[i], method_getTypeEncoding(altMethod));
+        method_exchangeImplementations(class_getInstanceMethod(cls, entries[i].originalSelector),
+                                       class_getInstanceMethod(cls, entries[i].replacementSelector));
+    }
+
+    for (NSUInteger i = 0; i < count; i++) {
+        entries[i].result = GrowingULSwizzleEntryResultInstalled;
+        entries[i].hook = [GrowingULSwizzleHook registerHookForClass:entries[i].cls
+                                                            selector:entries[i].originalSelector
+                                                         replacement:replacements[i]
+                                                            original:originals[i]];
+    }
+    free(replacements);
+    free(originals);
+    GrowingULSwizzleMethodListsDidChange();
+    return YES;
+}
+
 @implementation NSObject (GrowingULSwizzle)
 
 + (BOOL)growingul_swizzleMethod:(SEL)origSel_
@@ -106,7 +173,11 @@
     class_addMethod(self, origSel_, class_getMethodImplementation(self, origSel_), method_getTypeEncoding(origMethod));
     class_addMethod(self, altSel_, class_getMethodImplementation(self, altSel_), method_getTypeEncoding(altMethod));
 
+    IMP original = class_getMethodImplementation(self, origSel_);
+    IMP replacement = class_getMethodImplementation(self, altSel_);
     method_exchangeImplementations(class_getInstanceMethod(self, origSel_), class_getInstanceMethod(self, altSel_));
+    [GrowingULSwizzleHook registerHookForClass:self selector:origSel_ replacement:replacement original:original];
+    GrowingULSwizzleMethodListsDidChange();
     return YES;
 #else
     //    Scan for non-inherited methods.
@@ -211,4 +282,35 @@
     return invocation;
 }
 
++ (BOOL)growingul_swizzleMethod:(SEL)origSel
+               withBlockFactory:(id (^)(IMP original))factory
+                          error:(NSError **)error {
+    Method origMethod = class_getInstanceMethod(self, origSel);
+    if (!origMethod) {
+        GrowingSetNSError(error,
+                          @"original method %@ not found for class %@",
+                          NSStringFromSelector(origSel),
+                          [self class]);
+        return NO;
+    }
+
+    // Copy an inherited implementation into this class so that only this class is affected.
+    const char *types = method_getTypeEncoding(origMethod);
+    class_addMethod(self, origSel, method_getImplementation(origMethod), types);
+    origMethod = class_getInstanceMethod(self, origSel);
+
+    IMP original = method_getImplementation(origMethod);
+    IMP replacement = imp_implementationWithBlock(factory(original));
+    method_setImplementation(origMethod, replacement);
+    [GrowingULSwizzleHook registerHookForClass:self selector:origSel replacement:replacement original:original];
+    GrowingULSwizzleMethodListsDidChange();
+    return YES;
+}
+
++ (BOOL)growingul_swizzleClassMethod:(SEL)origSel
+                    withBlockFactory:(id (^)(IMP original))factory
+                               error:(NSError **)error {
+    return [GrowingGetClass((id)self) growingul_swizzleMethod:origSel withBlockFactory:factory error:error];
+}
+
 @end
@@ -0,0 +1,387 @@
+//
+//  GrowingULSwizzleHook.m
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingULSwizzleHook.h"
+#import "GrowingULSwizzler.h"
+#import "GrowingULTimeUtil.h"
+#import <objc/runtime.h>
+#import <os/lock.h>
+#import <pthread.h>
+#import <stdatomic.h>
+
+static os_unfair_lock growingul_hooksLock = OS_UNFAIR_LOCK_INIT;
+static atomic_bool growingul_hooksSuspended;
+// changed under growingul_hooksLock by every suspend and resume
+static atomic_uint growingul_suspendedHookCount;
+static atomic_ullong growingul_hookSuspensionGeneration;
+
+BOOL GrowingULSwizzleHooksSuspended(void) {
+    return atomic_load_explicit(&growingul_hooksSuspended, memory_order_relaxed);
+}
+
+BOOL GrowingULSwizzleHooksActive(uint64_t *generation) {
+    if (generation) {
+        *generation = atomic_load(&growingul_hookSuspensionGeneration);
+    }
+    return atomic_load(&growingul_suspendedHookCount) == 0 && !GrowingULSwizzleHooksSuspended();
+}
+
+#pragma mark - Counters
+
+// per-thread counters live in fixed chunks indexed by hook index - 1, so merging never races a reallocation
+#define GrowingULHookChunkShift 6
+#define GrowingULHookChunkSize (1 << GrowingULHookChunkShift)
+#define GrowingULHookChunkCount 64
+#define GrowingULHookMaxDepth 32
+
+BOOL GrowingULSwizzleHookInstrumentationActive = NO;
+
+typedef struct {
+    // written by the owning thread only, with plain loads and stores
+    _Atomic uint64_t calls;
+    _Atomic uint64_t nanos;
+} GrowingULHookCounter;
+
+typedef struct GrowingULHookThread {
+    struct GrowingULHookThread *next;
+    _Atomic(GrowingULHookCounter *) chunks[GrowingULHookChunkCount];
+    // open scopes of the thread; childNanos[d] is the time spent below the scope at depth d, 0 being the root
+    uint32_t depth;
+    uint64_t childNanos[GrowingULHookMaxDepth + 1];
+} GrowingULHookThread;
+
+static os_unfair_lock growingul_hookThreadsLock = OS_UNFAIR_LOCK_INIT;
+// guarded by growingul_hookThreadsLock: live threads, and the totals of the threads that exited
+static GrowingULHookThread *growingul_hookThreads;
+static GrowingULHookThread growingul_exitedHookThreads;
+static pthread_key_t growingul_hookThreadKey;
+static __thread GrowingULHookThread *growingul_currentHookThread;
+
+static void GrowingULHookCounterAdd(_Atomic uint64_t *counter, uint64_t value) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+static GrowingULHookCounter *GrowingULHookThreadCounter(GrowingULHookThread *thread, uint32_t index, BOOL create) {
+    uint32_t chunkIndex = (index - 1) >> GrowingULHookChunkShift;
+    if (chunkIndex >= GrowingULHookChunkCount) {
+        return NULL;
+    }
+    GrowingULHookCounter *chunk = atomic_load_explicit(&thread->chunks[chunkIndex], memory_order_acquire);
+    if (!chunk && create) {
+        chunk = calloc(GrowingULHookChunkSize, sizeof(GrowingULHookCounter));
+        atomic_store_explicit(&thread->chunks[chunkIndex], chunk, memory_order_release);
+    }
+    return chunk ? &chunk[(index - 1) & (GrowingULHookChunkSize - 1)] : NULL;
+}
+
+static void GrowingULHookThreadExit(void *value) {
+    GrowingULHookThread *thread = value;
+    os_unfair_lock_lock(&growingul_hookThreadsLock);
+    for (GrowingULHookThread **link = &growingul_hookThreads; *link; link = &(*link)->next) {
+        if (*link == thread) {
+            *link = thread->next;
+            break;
+        }
+    }
+    for (uint32_t chunkIndex = 0; chunkIndex < GrowingULHookChunkCount; chunkIndex++) {
+        GrowingULHookCounter *chunk = atomic_load_explicit(&thread->chunks[chunkIndex], memory_order_relaxed);
+        if (!chunk) {
+            continue;
+        }
+        for (uint32_t i = 0; i < GrowingULHookChunkSize; i++) {
+            uint32_t index = (chunkIndex << GrowingULHookChunkShift) + i + 1;
+            GrowingULHookCounter *exited = GrowingULHookThreadCounter(&growingul_exitedHookThreads, index, YES);
+            GrowingULHookCounterAdd(&exited->calls, atomic_load_explicit(&chunk[i].calls, memory_order_relaxed));
+            GrowingULHookCounterAdd(&exited->nanos, atomic_load_explicit(&chunk[i].nanos, memory_order_relaxed));
+        }
+        free(chunk);
+    }
+    os_unfair_lock_unlock(&growingul_hookThreadsLock);
+    free(thread);
+    growingul_currentHookThread = NULL;
+}
+
+static GrowingULHookThread *GrowingULCurrentHookThread(void) {
+    GrowingULHookThread *thread = growingul_currentHookThread;
+    if (__builtin_expect(thread != NULL, 1)) {
+        return thread;
+    }
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pthread_key_create(&growingul_hookThreadKey, GrowingULHookThreadExit);
+    });
+    thread = calloc(1, sizeof(GrowingULHookThread));
+    os_unfair_lock_lock(&growingul_hookThreadsLock);
+    thread->next = growingul_hookThreads;
+    growingul_hookThreads = thread;
+    os_unfair_lock_unlock(&growingul_hookThreadsLock);
+    pthread_setspecific(growingul_hookThreadKey, thread);
+    growingul_currentHookThread = thread;
+    return thread;
+}
+
+static GrowingULSwizzleHookStatistics GrowingULHookStatisticsForIndex(uint32_t index) {
+    GrowingULSwizzleHookStatistics statistics = {0};
+    os_unfair_lock_lock(&growingul_hookThreadsLock);
+    GrowingULHookCounter *exited = GrowingULHookThreadCounter(&growingul_exitedHookThreads, index, NO);
+    if (exited) {
+        statistics.calls += atomic_load_explicit(&exited->calls, memory_order_relaxed);
+        statistics.selfNanos += atomic_load_explicit(&exited->nanos, memory_order_relaxed);
+    }
+    for (GrowingULHookThread *thread = growingul_hookThreads; thread; thread = thread->next) {
+        GrowingULHookCounter *counter = GrowingULHookThreadCounter(thread, index, NO);
+        if (counter) {
+            statistics.calls += atomic_load_explicit(&counter->calls, memory_order_relaxed);
+            statistics.selfNanos += atomic_load_explicit(&counter->nanos, memory_order_relaxed);
+        }
+    }
+    os_unfair_lock_unlock(&growingul_hookThreadsLock);
+    return statistics;
+}
+
+GrowingULSwizzleHookScope GrowingULSwizzleHookScopeBegin(GrowingULSwizzleHook *hook) {
+    GrowingULSwizzleHookScope scope = {0, 0, 0};
+    uint32_t index = hook.index;
+    if (index == 0 || ((index - 1) >> GrowingULHookChunkShift) >= GrowingULHookChunkCount) {
+        return scope;
+    }
+    GrowingULHookThread *thread = GrowingULCurrentHookThread();
+    if (thread->depth == GrowingULHookMaxDepth) {
+        return scope;
+    }
+    scope.index = index;
+    scope.depth = ++thread->depth;
+    thread->childNanos[scope.depth] = 0;
+    scope.start = GrowingULMonotonicTimeNanos();
+    return scope;
+}
+
+void GrowingULSwizzleHookScopeEnd(GrowingULSwizzleHookScope *scope) {
+    uint64_t elapsed = GrowingULMonotonicTimeNanos() - scope->start;
+    GrowingULHookThread *thread = GrowingULCurrentHookThread();
+    if (thread->depth != scope->depth) {
+        // unbalanced, e.g. an exception unwound a scope without cleanup; drop the measurement
+        thread->depth = MIN(thread->depth, scope->depth - 1);
+        return;
+    }
+    uint64_t child = thread->childNanos[scope->depth];
+    thread->depth--;
+    thread->childNanos[thread->depth] += elapsed;
+    GrowingULHookCounter *counter = GrowingULHookThreadCounter(thread, scope->index, YES);
+    GrowingULHookCounterAdd(&counter->calls, 1);
+    GrowingULHookCounterAdd(&counter->nanos, elapsed > child ? elapsed - child : 0);
+}
+
+uint64_t GrowingULSwizzleHookOriginalBegin(void) {
+    return GrowingULMonotonicTimeNanos();
+}
+
+void GrowingULSwizzleHookOriginalEnd(uint64_t start) {
+    GrowingULHookThread *thread = GrowingULCurrentHookThread();
+    thread->childNanos[thread->depth] += GrowingULMonotonicTimeNanos() - start;
+}
+
+#pragma mark - Hooks
+
+// guarded by growingul_hooksLock
+static NSMutableArray<GrowingULSwizzleHook *> *GrowingULHooks(void) {
+    static NSMutableArray<GrowingULSwizzleHook *> *hooks;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        hooks = [NSMutableArray array];
+    });
+    return hooks;
+}
+
+// Only the class' own methods; an inherited method would be resolved through the superclass.
+static Method GrowingULOwnMethodWithImplementation(Class cls, IMP imp) {
+    unsigned int count = 0;
+    Method *methods = class_copyMethodList(cls, &count);
+    Method found = NULL;
+    for (unsigned int i = 0; i < count; i++) {
+        if (method_getImplementation(methods[i]) == imp) {
+            found = methods[i];
+            break;
+        }
+    }
+    free(methods);
+    return found;
+}
+
+@implementation GrowingULSwizzleHook {
+    IMP _replacement;
+    IMP _original;
+    // method whose IMP was redirected while bypassed
+    Method _alias;
+    // IMP installed by -suspend, checked by -resume before putting the hook back
+    IMP _installed;
+}
+
++ (instancetype)registerHookForClass:(Class)cls
+                            selector:(SEL)selector
+                         replacement:(IMP)replacement
+                            original:(IMP)original {
+    return [self registerHookForClass:cls selector:selector replacement:replacement original:original key:NULL];
+}
+
++ (instancetype)registerHookForClass:(Class)cls
+                            selector:(SEL)selector
+                         replacement:(IMP)replacement
+                            original:(IMP)original
+                                 key:(const void *)key {
+    GrowingULSwizzleHook *hook = [[self alloc] initWithClass:cls
+                                                    selector:selector
+                                                 replacement:replacement
+                                                    original:original];
+    hook->_key = key;
+    os_unfair_lock_lock(&growingul_hooksLock);
+    NSMutableArray<GrowingULSwizzleHook *> *hooks = GrowingULHooks();
+    [hooks addObject:hook];
+    hook->_index = (uint32_t)hooks.count;
+    os_unfair_lock_unlock(&growingul_hooksLock);
+    return hook;
+}
+
++ (BOOL)isInstrumentationEnabled {
+    return GrowingULSwizzleHookInstrumentationIsActive();
+}
+
++ (void)setInstrumentationEnabled:(BOOL)instrumentationEnabled {
+    __atomic_store_n(&GrowingULSwizzleHookInstrumentationActive, instrumentationEnabled, __ATOMIC_RELAXED);
+}
+
++ (void)enumerateStatisticsUsingBlock:(void (NS_NOESCAPE ^)(GrowingULSwizzleHook *hook,
+                                                            GrowingULSwizzleHookStatistics statistics,
+                                                            BOOL *stop))block {
+    BOOL stop = NO;
+    for (GrowingULSwizzleHook *hook in [self allHooks]) {
+        block(hook, [hook statistics], &stop);
+        if (stop) {
+            break;
+        }
+    }
+}
+
++ (instancetype)hookForClass:(Class)cls selector:(SEL)selector {
+    GrowingULSwizzleHook *found = nil;
+    os_unfair_lock_lock(&growingul_hooksLock);
+    for (GrowingULSwizzleHook *hook in GrowingULHooks().reverseObjectEnumerator) {
+        if (hook.hookedClass == cls && hook.selector == selector) {
+            found = hook;
+            break;
+        }
+    }
+    os_unfair_lock_unlock(&growingul_hooksLock);
+    return found;
+}
+
++ (NSArray<GrowingULSwizzleHook *> *)allHooks {
+    os_unfair_lock_lock(&growingul_hooksLock);
+    NSArray *hooks = [GrowingULHooks() copy];
+    os_unfair_lock_unlock(&growingul_hooksLock);
+    return hooks;
+}
+
++ (void)suspendAllHooks {
+    atomic_store_explicit(&growingul_hooksSuspended, true, memory_order_relaxed);
+    for (GrowingULSwizzleHook *hook in [self allHooks].reverseObjectEnumerator) {
+        [hook suspend];
+    }
+}
+
++ (void)resumeAllHooks {
+    for (GrowingULSwizzleHook *hook in [self allHooks]) {
+        [hook resume];
+    }
+    atomic_store_explicit(&growingul_hooksSuspended, false, memory_order_relaxed);
+}
+
+- (instancetype)initWithClass:(Class)cls selector:(SEL)selector replacement:(IMP)replacement original:(IMP)original {
+    self = [super init];
+    if (self) {
+        _hookedClass = cls;
+        _selector = selector;
+        _replacement = replacement;
+        _original = original;
+    }
+    return self;
+}
+
+- (IMP)originalImplementation {
+    // an inherited method is restored to whatever the superclass implements now
+    return _original ?: class_getMethodImplementation(class_getSuperclass(_hookedClass), _selector);
+}
+
+- (GrowingULSwizzleHookState)suspend {
+    os_unfair_lock_lock(&growingul_hooksLock);
+    if (!_suspended) {
+        Method method = class_getInstanceMethod(_hookedClass, _selector);
+        IMP original = [self originalImplementation];
+        if (method_getImplementation(method) == _replacement) {
+            method_setImplementation(method, original);
+            _state = GrowingULSwizzleHookStateRestored;
+        } else if ((_alias = GrowingULOwnMethodWithImplementation(_hookedClass, _replacement))) {
+            method_setImplementation(_alias, original);
+            _state = GrowingULSwizzleHookStateBypassed;
+        } else {
+            _state = GrowingULSwizzleHookStatePassthrough;
+        }
+        _installed = original;
+        _suspended = YES;
+        atomic_fetch_add(&growingul_suspendedHookCount, 1);
+        atomic_fetch_add(&growingul_hookSuspensionGeneration, 1);
+        GrowingULSwizzleMethodListsDidChange();
+    }
+    GrowingULSwizzleHookState state = _state;
+    os_unfair_lock_unlock(&growingul_hooksLock);
+    return state;
+}
+
+- (BOOL)resume {
+    os_unfair_lock_lock(&growingul_hooksLock);
+    BOOL resumed = YES;
+    if (_suspended) {
+        Method method = _state == GrowingULSwizzleHookStateRestored ? class_getInstanceMethod(_hookedClass, _selector)
+                        : _state == GrowingULSwizzleHookStateBypassed ? _alias
+                                                                       : NULL;
+        if (method && method_getImplementation(method) != _installed) {
+            // swizzled again on top of the restored original; putting the hook back would drop that hook
+            resumed = NO;
+        } else {
+            if (method) {
+                method_setImplementation(method, _replacement);
+            }
+            _alias = NULL;
+            _installed = NULL;
+            _state = GrowingULSwizzleHookStateActive;
+            _suspended = NO;
+            atomic_fetch_sub(&growingul_suspendedHookCount, 1);
+            atomic_fetch_add(&growingul_hookSuspensionGeneration, 1);
+            GrowingULSwizzleMethodListsDidChange();
+        }
+    }
+    os_unfair_lock_unlock(&growingul_hooksLock);
+    return resumed;
+}
+
+- (GrowingULSwizzleHookStatistics)statistics {
+    return GrowingULHookStatisticsForIndex(_index);
+}
+
+@end
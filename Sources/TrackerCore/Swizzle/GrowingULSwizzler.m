@@ -41,9 +41,11 @@
 //  limitations under the License.
 
 #import "GrowingULSwizzler.h"
+#import "GrowingULPointerMap.h"
 #import <objc/runtime.h>
 #import <objc/message.h>
 #import <os/lock.h>
+#import <stdatomic.h>
 
 #if !__has_feature(objc_arc)
 #error This code needs ARC. Use compiler option -fobjc-arc
@@ -195,19 +197,98 @@ static BOOL blockIsAnImpFactoryBlock(id block){
 #pragma mark - Swizzling
 
 #pragma mark └ GrowingULSwizzleInfo
-typedef IMP (^GUSWizzleImpProvider)(void);
+
+// Bumped whenever a method list is changed through the swizzling APIs; memoized superclass
+// implementations are only trusted while their generation is current.
+static atomic_ulong methodListGeneration = 1;
+
+void GrowingULSwizzleMethodListsDidChange(void) {
+    atomic_fetch_add_explicit(&methodListGeneration, 1, memory_order_release);
+}
 
 @interface GrowingULSwizzleInfo()
-@property (nonatomic,copy) GUSWizzleImpProvider impProviderBlock;
 @property (nonatomic, readwrite) SEL selector;
+@property (atomic, strong, readwrite) GrowingULSwizzleHook *hook;
 @end
 
-@implementation GrowingULSwizzleInfo
+@implementation GrowingULSwizzleInfo {
+    Class _swizzledClass;
+    // Held by the swizzler across class_replaceMethod until _originalIMP is published.
+    os_unfair_lock _lock;
+    _Atomic(IMP) _originalIMP;
+    atomic_bool _published;
+    // Superclass implementation used when the swizzled class did not implement the method itself, and the
+    // method it was read from; written under _lock, _superGeneration is 0 while they change.
+    _Atomic(Method) _superMethod;
+    _Atomic(IMP) _superIMP;
+    atomic_ulong _superGeneration;
+}
+
+- (instancetype)initWithClass:(Class)swizzledClass selector:(SEL)selector {
+    self = [super init];
+    if (self) {
+        _swizzledClass = swizzledClass;
+        _selector = selector;
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (void)beginPublishing {
+    os_unfair_lock_lock(&_lock);
+}
+
+- (void)publishOriginalImplementation:(IMP)originalIMP {
+    atomic_store_explicit(&_originalIMP, originalIMP, memory_order_relaxed);
+    atomic_store_explicit(&_published, true, memory_order_release);
+    os_unfair_lock_unlock(&_lock);
+}
 
 -(GrowingULSwizzleOriginalIMP)getOriginalImplementation{
-    NSAssert(_impProviderBlock,nil);
+    if (__builtin_expect(!atomic_load_explicit(&_published, memory_order_acquire), 0)) {
+        // Another thread called the new implementation between class_replaceMethod and its
+        // return value being published; wait for the swizzler.
+        os_unfair_lock_lock(&_lock);
+        os_unfair_lock_unlock(&_lock);
+    }
+    IMP imp = atomic_load_explicit(&_originalIMP, memory_order_relaxed);
+    if (NULL == imp){
+        imp = [self superImplementation];
+    }
     // Casting IMP to GrowingULSwizzleOriginalIMP to force user casting.
-    return (GrowingULSwizzleOriginalIMP)_impProviderBlock();
+    return (GrowingULSwizzleOriginalIMP)imp;
+}
+
+- (IMP)superImplementation {
+    unsigned long generation = atomic_load_explicit(&methodListGeneration, memory_order_acquire);
+    unsigned long cached = atomic_load_explicit(&_superGeneration, memory_order_acquire);
+    if (cached == generation) {
+        Method method = atomic_load_explicit(&_superMethod, memory_order_relaxed);
+        IMP imp = atomic_load_explicit(&_superIMP, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        // An implementation exchanged or replaced by another library, without bumping the generation, still shows
+        // on the method it was read from.
+        if (atomic_load_explicit(&_superGeneration, memory_order_relaxed) == cached &&
+            (!method || method_getImplementation(method) == imp)) {
+            return imp;
+        }
+    }
+
+    // If the class does not implement the method
+    // we need to find an implementation in one of the superclasses.
+    os_unfair_lock_lock(&_lock);
+    generation = atomic_load_explicit(&methodListGeneration, memory_order_acquire);
+    Class superclass = class_getSuperclass(_swizzledClass);
+    Method method = class_getInstanceMethod(superclass, _selector);
+    // no method anywhere up the hierarchy: the forwarding IMP
+    IMP imp = method ? method_getImplementation(method) : class_getMethodImplementation(superclass, _selector);
+    atomic_store_explicit(&_superGeneration, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&_superMethod, method, memory_order_relaxed);
+    atomic_store_explicit(&_superIMP, imp, memory_order_relaxed);
+    atomic_store_explicit(&_superGeneration, generation, memory_order_release);
+    os_unfair_lock_unlock(&_lock);
+    return imp;
 }
 
 @end
@@ -216,9 +297,10 @@ typedef IMP (^GUSWizzleImpProvider)(void);
 #pragma mark └ GrowingULSwizzle
 @implementation GrowingULSwizzle
 
-static void swizzle(Class classToSwizzle,
-                    SEL selector,
-                    GrowingULSwizzleImpFactoryBlock factoryBlock)
+static GrowingULSwizzleHook *swizzle(Class classToSwizzle,
+                                     SEL selector,
+                                     GrowingULSwizzleImpFactoryBlock factoryBlock,
+                                     const void *key)
 {
     Method method = class_getInstanceMethod(classToSwizzle, selector);
     
@@ -231,32 +313,9 @@ static void swizzle(Class classToSwizzle,
     NSCAssert(blockIsAnImpFactoryBlock(factoryBlock),
              @"Wrong type of implementation factory block.");
     
-    __block os_unfair_lock lock = OS_UNFAIR_LOCK_INIT;
-    // To keep things thread-safe, we fill in the originalIMP later,
+    // To keep things thread-safe, the original implementation is published later,
     // with the result of the class_replaceMethod call below.
-    __block IMP originalIMP = NULL;
-
-    // This block will be called by the client to get original implementation and call it.
-    GUSWizzleImpProvider originalImpProvider = ^IMP{
-        // It's possible that another thread can call the method between the call to
-        // class_replaceMethod and its return value being set.
-        // So to be sure originalIMP has the right value, we need a lock.
-        os_unfair_lock_lock(&lock);
-        IMP imp = originalIMP;
-        os_unfair_lock_unlock(&lock);
-        
-        if (NULL == imp){
-            // If the class does not implement the method
-            // we need to find an implementation in one of the superclasses.
-            Class superclass = class_getSuperclass(classToSwizzle);
-            imp = method_getImplementation(class_getInstanceMethod(superclass,selector));
-        }
-        return imp;
-    };
-    
-    GrowingULSwizzleInfo *swizzleInfo = [GrowingULSwizzleInfo new];
-    swizzleInfo.selector = selector;
-    swizzleInfo.impProviderBlock = originalImpProvider;
+    GrowingULSwizzleInfo *swizzleInfo = [[GrowingULSwizzleInfo alloc] initWithClass:classToSwizzle selector:selector];
     
     // We ask the client for the new implementation block.
     // We pass swizzleInfo as an argument to factory block, so the client can
@@ -277,31 +336,155 @@ static void swizzle(Class classToSwizzle,
     // If the class does not implement the method itself then
     // class_replaceMethod returns NULL and superclasses's implementation will be used.
     //
-    // We need a lock to be sure that originalIMP has the right value in the
-    // originalImpProvider block above.
-    os_unfair_lock_lock(&lock);
-    originalIMP = class_replaceMethod(classToSwizzle, selector, newIMP, methodType);
-    os_unfair_lock_unlock(&lock);
+    // Calls made before the result is published wait on the info's lock; every
+    // call after that reads the published IMP without locking.
+    [swizzleInfo beginPublishing];
+    IMP originalIMP = class_replaceMethod(classToSwizzle, selector, newIMP, methodType);
+    [swizzleInfo publishOriginalImplementation:originalIMP];
+    GrowingULSwizzleMethodListsDidChange();
+    GrowingULSwizzleHook *hook = [GrowingULSwizzleHook registerHookForClass:classToSwizzle
+                                                                   selector:selector
+                                                                replacement:newIMP
+                                                                   original:originalIMP
+                                                                        key:key];
+    // calls made before this line are not counted
+    swizzleInfo.hook = hook;
+    return hook;
 }
 
-static NSMutableDictionary *swizzledClassesDictionary(void){
-    static NSMutableDictionary *swizzledClasses;
+#pragma mark └ Swizzled classes registry
+
+typedef NS_OPTIONS(uint8_t, GrowingULSwizzleRecordFlags) {
+    GrowingULSwizzleRecordSwizzled = 1 << 0,
+    // positive verdict cached for GrowingULSwizzleModeOncePerClassAndSuperclasses, never revoked
+    GrowingULSwizzleRecordAncestorSwizzled = 1 << 1,
+};
+
+typedef struct {
+    GrowingULSwizzleRecordFlags flags;
+    // negative verdict for GrowingULSwizzleModeOncePerClassAndSuperclasses: neither the class nor an ancestor was
+    // swizzled as of this generation; 0 if never checked
+    uint64_t clearGeneration;
+} GrowingULSwizzleRecord;
+
+// Negative verdicts are only trusted while their generation is current. A verdict on a class can only be made stale
+// by claiming that class or one of its ancestors, and every walk that produced it recorded one on them too, so the
+// generation only moves when a class carrying a verdict is claimed.
+static atomic_ullong swizzleVerdictGeneration = 1;
+
+// Serializes the ancestor check and the claim of GrowingULSwizzleModeOncePerClassAndSuperclasses, so that a class
+// and its superclass swizzled concurrently cannot both pass the check. Claims in the other modes only take their
+// shard's lock; a key is expected to be used with one mode.
+static os_unfair_lock swizzleHierarchyLock = OS_UNFAIR_LOCK_INIT;
+
+// Classes are spread over shards by address so that first-time swizzles of unrelated
+// classes do not contend. Each shard maps key -> (class -> GrowingULSwizzleRecord).
+#define GrowingULSwizzleShardCount 16
+
+typedef struct {
+    os_unfair_lock lock;
+    GrowingULPointerMap *keys;
+} GrowingULSwizzleShard;
+
+static GrowingULSwizzleShard *swizzleShardForClass(Class cls){
+    static GrowingULSwizzleShard shards[GrowingULSwizzleShardCount];
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
-        swizzledClasses = [NSMutableDictionary new];
+        for (int i = 0; i < GrowingULSwizzleShardCount; i++) {
+            shards[i].lock = OS_UNFAIR_LOCK_INIT;
+            shards[i].keys = GrowingULPointerMapCreate(sizeof(GrowingULPointerMap *));
+        }
     });
-    return swizzledClasses;
+    uintptr_t address = (uintptr_t)(__bridge void *)cls;
+    return &shards[((address >> 4) ^ (address >> 12)) % GrowingULSwizzleShardCount];
+}
+
+// Must be called with shard->lock held.
+static GrowingULSwizzleRecord *swizzleRecordLocked(GrowingULSwizzleShard *shard, const void *key, Class cls){
+    BOOL inserted = NO;
+    GrowingULPointerMap **classes = GrowingULPointerMapGetOrInsert(shard->keys, key, &inserted);
+    if (inserted) {
+        *classes = GrowingULPointerMapCreate(sizeof(GrowingULSwizzleRecord));
+    }
+    return GrowingULPointerMapGetOrInsert(*classes, (__bridge const void *)cls, NULL);
 }
 
-static NSMutableSet *swizzledClassesForKey(const void *key){
-    NSMutableDictionary *classesDictionary = swizzledClassesDictionary();
-    NSValue *keyValue = [NSValue valueWithPointer:key];
-    NSMutableSet *swizzledClasses = [classesDictionary objectForKey:keyValue];
-    if (!swizzledClasses) {
-        swizzledClasses = [NSMutableSet new];
-        [classesDictionary setObject:swizzledClasses forKey:keyValue];
+static GrowingULSwizzleRecord swizzleRecordForClass(const void *key, Class cls){
+    GrowingULSwizzleShard *shard = swizzleShardForClass(cls);
+    GrowingULSwizzleRecord record = {0};
+    os_unfair_lock_lock(&shard->lock);
+    GrowingULPointerMap **classes = GrowingULPointerMapGet(shard->keys, key);
+    if (classes) {
+        GrowingULSwizzleRecord *stored = GrowingULPointerMapGet(*classes, (__bridge const void *)cls);
+        record = stored ? *stored : record;
     }
-    return swizzledClasses;
+    os_unfair_lock_unlock(&shard->lock);
+    return record;
+}
+
+// Sets flags on the record of cls unless one of the conflicting flags is already set.
+static BOOL swizzleRecordMark(const void *key,
+                              Class cls,
+                              GrowingULSwizzleRecordFlags flags,
+                              GrowingULSwizzleRecordFlags conflicting){
+    GrowingULSwizzleShard *shard = swizzleShardForClass(cls);
+    os_unfair_lock_lock(&shard->lock);
+    GrowingULSwizzleRecord *record = swizzleRecordLocked(shard, key, cls);
+    BOOL marked = (record->flags & conflicting) == 0;
+    if (marked) {
+        record->flags |= flags;
+        if ((flags & GrowingULSwizzleRecordSwizzled) && record->clearGeneration != 0) {
+            // a walk from a subclass went through cls
+            atomic_fetch_add_explicit(&swizzleVerdictGeneration, 1, memory_order_relaxed);
+            record->clearGeneration = 0;
+        }
+    }
+    os_unfair_lock_unlock(&shard->lock);
+    return marked;
+}
+
+static void swizzleRecordSetClear(const void *key, Class cls, uint64_t generation){
+    GrowingULSwizzleShard *shard = swizzleShardForClass(cls);
+    os_unfair_lock_lock(&shard->lock);
+    GrowingULSwizzleRecord *record = swizzleRecordLocked(shard, key, cls);
+    if (record->flags == 0) {
+        record->clearGeneration = generation;
+    }
+    os_unfair_lock_unlock(&shard->lock);
+}
+
+// Must be called with swizzleHierarchyLock held. Walks up to the first ancestor whose record answers for the rest
+// of the chain, recording negative verdicts on the way, and claims cls if the chain is clear.
+static BOOL swizzleClaimClassAndSuperclassesLocked(const void *key, Class cls){
+    if (swizzleRecordForClass(key, cls).flags != 0) {
+        return NO;
+    }
+    uint64_t generation = atomic_load_explicit(&swizzleVerdictGeneration, memory_order_relaxed);
+    Class verified = Nil;
+    for (Class currentClass = class_getSuperclass(cls);
+         nil != currentClass;
+         currentClass = class_getSuperclass(currentClass))
+    {
+        GrowingULSwizzleRecord record = swizzleRecordForClass(key, currentClass);
+        if (record.flags != 0) {
+            swizzleRecordMark(key, cls, GrowingULSwizzleRecordAncestorSwizzled, 0);
+            return NO;
+        }
+        if (record.clearGeneration == generation) {
+            verified = currentClass;
+            break;
+        }
+    }
+    for (Class currentClass = class_getSuperclass(cls);
+         currentClass != verified;
+         currentClass = class_getSuperclass(currentClass))
+    {
+        swizzleRecordSetClear(key, currentClass, generation);
+    }
+    return swizzleRecordMark(key,
+                             cls,
+                             GrowingULSwizzleRecordSwizzled,
+                             GrowingULSwizzleRecordSwizzled | GrowingULSwizzleRecordAncestorSwizzled);
 }
 
 +(BOOL)swizzleInstanceMethod:(SEL)selector
@@ -309,37 +492,42 @@ static NSMutableSet *swizzledClassesForKey(const void *key){
                newImpFactory:(GrowingULSwizzleImpFactoryBlock)factoryBlock
                         mode:(GrowingULSwizzleMode)mode
                          key:(const void *)key
+{
+    return nil != [self installHookForInstanceMethod:selector
+                                             inClass:classToSwizzle
+                                       newImpFactory:factoryBlock
+                                                mode:mode
+                                                 key:key];
+}
+
++(GrowingULSwizzleHook *)installHookForInstanceMethod:(SEL)selector
+                                              inClass:(Class)classToSwizzle
+                                        newImpFactory:(GrowingULSwizzleImpFactoryBlock)factoryBlock
+                                                 mode:(GrowingULSwizzleMode)mode
+                                                  key:(const void *)key
 {
     NSAssert(!(NULL == key && GrowingULSwizzleModeAlways != mode),
              @"Key may not be NULL if mode is not GrowingULSwizzleModeAlways.");
 
-    @synchronized(swizzledClassesDictionary()){
-        if (key){
-            NSSet *swizzledClasses = swizzledClassesForKey(key);
-            if (mode == GrowingULSwizzleModeOncePerClass) {
-                if ([swizzledClasses containsObject:classToSwizzle]){
-                    return NO;
-                }
-            }else if (mode == GrowingULSwizzleModeOncePerClassAndSuperclasses){
-                for (Class currentClass = classToSwizzle;
-                     nil != currentClass;
-                     currentClass = class_getSuperclass(currentClass))
-                {
-                    if ([swizzledClasses containsObject:currentClass]) {
-                        return NO;
-                    }
-                }
-            }
+    // Claim the class before swizzling so that no lock is held while the factory block runs.
+    if (key && mode == GrowingULSwizzleModeOncePerClassAndSuperclasses){
+        os_unfair_lock_lock(&swizzleHierarchyLock);
+        BOOL claimed = swizzleClaimClassAndSuperclassesLocked(key, classToSwizzle);
+        os_unfair_lock_unlock(&swizzleHierarchyLock);
+        if (!claimed) {
+            return nil;
         }
-        
-        swizzle(classToSwizzle, selector, factoryBlock);
-        
-        if (key){
-            [swizzledClassesForKey(key) addObject:classToSwizzle];
+    }else if (key){
+        GrowingULSwizzleRecordFlags conflicting = 0;
+        if (mode == GrowingULSwizzleModeOncePerClass) {
+            conflicting = GrowingULSwizzleRecordSwizzled;
+        }
+        if (!swizzleRecordMark(key, classToSwizzle, GrowingULSwizzleRecordSwizzled, conflicting)) {
+            return nil;
         }
     }
     
-    return YES;
+    return swizzle(classToSwizzle, selector, factoryBlock, key);
 }
 
 +(void)swizzleClassMethod:(SEL)selector
@@ -19,16 +19,31 @@
 
 #import "GrowingULTimeUtil.h"
 
+int64_t GrowingULWallClockOffsetNanos = 0;
+
+int64_t GrowingULWallClockAnchor(void) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        [[NSNotificationCenter defaultCenter] addObserverForName:NSSystemClockDidChangeNotification
+                                                          object:nil
+                                                           queue:nil
+                                                      usingBlock:^(NSNotification *notification) {
+                                                          GrowingULWallClockAnchor();
+                                                      }];
+    });
+    int64_t offset = (int64_t)GrowingULWallTimeNanos() - (int64_t)GrowingULContinuousTimeNanos();
+    __atomic_store_n(&GrowingULWallClockOffsetNanos, offset, __ATOMIC_RELAXED);
+    return offset;
+}
+
 @implementation GrowingULTimeUtil
 
 + (long long)currentTimeMillis {
-    NSDate *dateNow = [NSDate date];
-    return (long long)([dateNow timeIntervalSince1970] * 1000LL);
+    return (long long)(GrowingULWallTimeNanos() / NSEC_PER_MSEC);
 }
 
 + (double)currentSystemTimeMillis {
-    NSProcessInfo *processInfo = NSProcessInfo.processInfo;
-    return processInfo.systemUptime * 1000;
+    return (double)GrowingULMonotonicTimeNanos() / NSEC_PER_MSEC;
 }
 
 @end
@@ -0,0 +1,127 @@
+//
+//  GrowingULClassTable.m
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingULClassTable.h"
+#import "GrowingULPointerMap.h"
+#import <os/lock.h>
+#import <stdatomic.h>
+
+// entries live in fixed chunks that never move, so readers need no lock
+#define GrowingULClassChunkShift 8
+#define GrowingULClassChunkSize (1 << GrowingULClassChunkShift)
+#define GrowingULClassChunkCount 1024
+
+typedef struct {
+    __unsafe_unretained Class cls;
+    __unsafe_unretained NSString *name;
+} GrowingULClassEntry;
+
+static os_unfair_lock growingul_classLock = OS_UNFAIR_LOCK_INIT;
+// guarded by growingul_classLock; Class -> GrowingULClassId
+static GrowingULPointerMap *growingul_classIds;
+// guarded by growingul_classLock; owns the names referenced by the entries
+static NSMutableArray<NSString *> *growingul_classNames;
+static _Atomic(GrowingULClassEntry *) growingul_classChunks[GrowingULClassChunkCount];
+// published after the entry it counts is written
+static _Atomic uint32_t growingul_classCount;
+
+static const GrowingULClassEntry *GrowingULClassEntryForId(GrowingULClassId classId) {
+    if (classId == 0 || classId > atomic_load_explicit(&growingul_classCount, memory_order_acquire)) {
+        return NULL;
+    }
+    uint32_t index = classId - 1;
+    GrowingULClassEntry *chunk =
+        atomic_load_explicit(&growingul_classChunks[index >> GrowingULClassChunkShift], memory_order_relaxed);
+    return &chunk[index & (GrowingULClassChunkSize - 1)];
+}
+
+static GrowingULClassId GrowingULClassInternLocked(Class cls) {
+    uint32_t count = atomic_load_explicit(&growingul_classCount, memory_order_relaxed);
+    uint32_t chunkIndex = count >> GrowingULClassChunkShift;
+    if (chunkIndex >= GrowingULClassChunkCount) {
+        return 0;
+    }
+    GrowingULClassEntry *chunk = atomic_load_explicit(&growingul_classChunks[chunkIndex], memory_order_relaxed);
+    if (!chunk) {
+        chunk = calloc(GrowingULClassChunkSize, sizeof(GrowingULClassEntry));
+        atomic_store_explicit(&growingul_classChunks[chunkIndex], chunk, memory_order_relaxed);
+    }
+    if (!growingul_classNames) {
+        growingul_classNames = [NSMutableArray array];
+    }
+    NSString *name = [NSStringFromClass(cls) copy];
+    [growingul_classNames addObject:name];
+    chunk[count & (GrowingULClassChunkSize - 1)] = (GrowingULClassEntry){cls, name};
+    atomic_store_explicit(&growingul_classCount, count + 1, memory_order_release);
+    return count + 1;
+}
+
+GrowingULClassId GrowingULClassIdForClass(Class cls) {
+    if (!cls) {
+        return 0;
+    }
+    BOOL inserted = NO;
+    os_unfair_lock_lock(&growingul_classLock);
+    if (!growingul_classIds) {
+        growingul_classIds = GrowingULPointerMapCreate(sizeof(GrowingULClassId));
+    }
+    GrowingULClassId *stored =
+        GrowingULPointerMapGetOrInsert(growingul_classIds, (__bridge const void *)cls, &inserted);
+    if (inserted) {
+        // a full table keeps answering 0 for the classes it could not take
+        *stored = GrowingULClassInternLocked(cls);
+    }
+    GrowingULClassId classId = *stored;
+    os_unfair_lock_unlock(&growingul_classLock);
+    return classId;
+}
+
+NSString *GrowingULClassNameForId(GrowingULClassId classId) {
+    const GrowingULClassEntry *entry = GrowingULClassEntryForId(classId);
+    return entry ? entry->name : nil;
+}
+
+Class GrowingULClassForId(GrowingULClassId classId) {
+    const GrowingULClassEntry *entry = GrowingULClassEntryForId(classId);
+    return entry ? entry->cls : Nil;
+}
+
+NSString *GrowingULClassNameForClass(Class cls) {
+    GrowingULClassId classId = GrowingULClassIdForClass(cls);
+    return classId ? GrowingULClassNameForId(classId) : (cls ? NSStringFromClass(cls) : nil);
+}
+
+void GrowingULClassNamesForIds(const GrowingULClassId *ids, NSUInteger count, NSString *__unsafe_unretained *names) {
+    uint32_t known = atomic_load_explicit(&growingul_classCount, memory_order_acquire);
+    for (NSUInteger i = 0; i < count; i++) {
+        GrowingULClassId classId = ids[i];
+        if (classId == 0 || classId > known) {
+            names[i] = nil;
+            continue;
+        }
+        uint32_t index = classId - 1;
+        GrowingULClassEntry *chunk =
+            atomic_load_explicit(&growingul_classChunks[index >> GrowingULClassChunkShift], memory_order_relaxed);
+        names[i] = chunk[index & (GrowingULClassChunkSize - 1)].name;
+    }
+}
+
+NSUInteger GrowingULClassTableCount(void) {
+    return atomic_load_explicit(&growingul_classCount, memory_order_acquire);
+}
@@ -0,0 +1,132 @@
+//
+//  GrowingULLatencyHistogram.m
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingULLatencyHistogram.h"
+#import <stdatomic.h>
+
+// values below 8 get exact buckets, every power of two from 2^3 to 2^40 gets 8 more
+static const unsigned GrowingULLatencySubBucketBits = 3;
+static const unsigned GrowingULLatencyBucketCount = 312;
+
+struct GrowingULLatencyHistogram {
+    atomic_uint_least64_t count;
+    atomic_uint_least64_t max;
+    atomic_uint_least32_t buckets[GrowingULLatencyBucketCount];
+};
+
+static inline unsigned GrowingULLatencyBucketIndex(uint64_t nanos) {
+    if (nanos < (1u << GrowingULLatencySubBucketBits)) {
+        return (unsigned)nanos;
+    }
+    unsigned exponent = 63 - __builtin_clzll(nanos);
+    unsigned sub = (unsigned)(nanos >> (exponent - GrowingULLatencySubBucketBits)) & 7;
+    unsigned index = (exponent - 2) * 8 + sub;
+    return MIN(index, GrowingULLatencyBucketCount - 1);
+}
+
+// midpoint of the bucket's value range
+static inline uint64_t GrowingULLatencyBucketValue(unsigned index) {
+    if (index < 8) {
+        return index;
+    }
+    unsigned exponent = index / 8 + 2;
+    unsigned shift = exponent - GrowingULLatencySubBucketBits;
+    uint64_t lower = (uint64_t)(8 + index % 8) << shift;
+    return lower + ((1ULL << shift) >> 1);
+}
+
+GrowingULLatencyHistogram *GrowingULLatencyHistogramCreate(void) {
+    return calloc(1, sizeof(GrowingULLatencyHistogram));
+}
+
+void GrowingULLatencyHistogramDestroy(GrowingULLatencyHistogram *histogram) {
+    free(histogram);
+}
+
+void GrowingULLatencyHistogramRecord(GrowingULLatencyHistogram *histogram, uint64_t nanos) {
+    atomic_fetch_add_explicit(&histogram->buckets[GrowingULLatencyBucketIndex(nanos)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->count, 1, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    while (nanos > max &&
+           !atomic_compare_exchange_weak_explicit(&histogram->max, &max, nanos, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+GrowingULLatencySummary GrowingULLatencyHistogramSummarize(const GrowingULLatencyHistogram *histogram) {
+    GrowingULLatencySummary summary = {0};
+    uint32_t buckets[GrowingULLatencyBucketCount];
+    uint64_t total = 0;
+    // count buckets ourselves, the separate counter may run ahead of them while recording is in flight
+    for (unsigned i = 0; i < GrowingULLatencyBucketCount; i++) {
+        buckets[i] = atomic_load_explicit((atomic_uint_least32_t *)&histogram->buckets[i], memory_order_relaxed);
+        total += buckets[i];
+    }
+    summary.count = total;
+    summary.maxNanos = atomic_load_explicit((atomic_uint_least64_t *)&histogram->max, memory_order_relaxed);
+    if (total == 0) {
+        return summary;
+    }
+
+    uint64_t p50Rank = (total + 1) / 2;
+    uint64_t p99Rank = total - total / 100;
+    uint64_t seen = 0;
+    BOOL reachedP50 = NO;
+    for (unsigned i = 0; i < GrowingULLatencyBucketCount; i++) {
+        if (buckets[i] == 0) {
+            continue;
+        }
+        seen += buckets[i];
+        if (!reachedP50 && seen >= p50Rank) {
+            reachedP50 = YES;
+            summary.p50Nanos = MIN(GrowingULLatencyBucketValue(i), summary.maxNanos);
+        }
+        if (seen >= p99Rank) {
+            summary.p99Nanos = MIN(GrowingULLatencyBucketValue(i), summary.maxNanos);
+            break;
+        }
+    }
+    return summary;
+}
+
+@implementation GrowingULDelegateLatency
+
+- (instancetype)initWithDelegateClass:(Class)delegateClass
+                             selector:(SEL)selector
+                              summary:(GrowingULLatencySummary)summary {
+    self = [super init];
+    if (self) {
+        _delegateClass = delegateClass;
+        _selector = selector;
+        _summary = summary;
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@ %@ count=%llu p50=%lluns p99=%lluns max=%lluns>",
+                                      NSStringFromClass(_delegateClass),
+                                      NSStringFromSelector(_selector),
+                                      _summary.count,
+                                      _summary.p50Nanos,
+                                      _summary.p99Nanos,
+                                      _summary.maxNanos];
+}
+
+@end
@@ -0,0 +1,174 @@
+//
+//  GrowingULPointerMap.m
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingULPointerMap.h"
+
+static const size_t GrowingULPointerMapInitialCapacity = 16;
+
+struct GrowingULPointerMap {
+    const void **keys;
+    uint8_t *values;
+    size_t valueSize;
+    size_t mask;
+    size_t count;
+};
+
+static inline size_t GrowingULPointerHash(const void *key) {
+    // fmix64 from MurmurHash3, spreads the low-entropy alignment bits of addresses
+    uint64_t h = (uint64_t)(uintptr_t)key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+static inline void *GrowingULPointerMapValueAt(const GrowingULPointerMap *map, size_t index) {
+    return map->values + index * map->valueSize;
+}
+
+static void GrowingULPointerMapAllocate(GrowingULPointerMap *map, size_t capacity) {
+    map->keys = calloc(capacity, sizeof(void *));
+    map->values = calloc(capacity, MAX(map->valueSize, 1));
+    map->mask = capacity - 1;
+    map->count = 0;
+}
+
+static size_t GrowingULPointerMapFind(const GrowingULPointerMap *map, const void *key, BOOL *found) {
+    size_t index = GrowingULPointerHash(key) & map->mask;
+    while (map->keys[index]) {
+        if (map->keys[index] == key) {
+            *found = YES;
+            return index;
+        }
+        index = (index + 1) & map->mask;
+    }
+    *found = NO;
+    return index;
+}
+
+static void GrowingULPointerMapGrow(GrowingULPointerMap *map) {
+    const void **oldKeys = map->keys;
+    uint8_t *oldValues = map->values;
+    size_t oldCapacity = map->mask + 1;
+    GrowingULPointerMapAllocate(map, oldCapacity * 2);
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (!oldKeys[i]) {
+            continue;
+        }
+        BOOL found;
+        size_t index = GrowingULPointerMapFind(map, oldKeys[i], &found);
+        map->keys[index] = oldKeys[i];
+        memcpy(GrowingULPointerMapValueAt(map, index), oldValues + i * map->valueSize, map->valueSize);
+        map->count++;
+    }
+    free(oldKeys);
+    free(oldValues);
+}
+
+GrowingULPointerMap *GrowingULPointerMapCreate(size_t valueSize) {
+    GrowingULPointerMap *map = calloc(1, sizeof(GrowingULPointerMap));
+    map->valueSize = valueSize;
+    GrowingULPointerMapAllocate(map, GrowingULPointerMapInitialCapacity);
+    return map;
+}
+
+void GrowingULPointerMapDestroy(GrowingULPointerMap *map) {
+    if (!map) {
+        return;
+    }
+    free(map->keys);
+    free(map->values);
+    free(map);
+}
+
+NSUInteger GrowingULPointerMapCount(const GrowingULPointerMap *map) {
+    return map->count;
+}
+
+void *GrowingULPointerMapGet(const GrowingULPointerMap *map, const void *key) {
+    BOOL found;
+    size_t index = GrowingULPointerMapFind(map, key, &found);
+    return found ? GrowingULPointerMapValueAt(map, index) : NULL;
+}
+
+void *GrowingULPointerMapGetOrInsert(GrowingULPointerMap *map, const void *key, BOOL *inserted) {
+    NSCParameterAssert(key);
+    BOOL found;
+    size_t index = GrowingULPointerMapFind(map, key, &found);
+    if (!found) {
+        // keep the load factor at or below 3/4
+        if ((map->count + 1) * 4 > (map->mask + 1) * 3) {
+            GrowingULPointerMapGrow(map);
+            index = GrowingULPointerMapFind(map, key, &found);
+        }
+        map->keys[index] = key;
+        memset(GrowingULPointerMapValueAt(map, index), 0, map->valueSize);
+        map->count++;
+    }
+    if (inserted) {
+        *inserted = !found;
+    }
+    return GrowingULPointerMapValueAt(map, index);
+}
+
+BOOL GrowingULPointerMapRemove(GrowingULPointerMap *map, const void *key) {
+    BOOL found;
+    size_t hole = GrowingULPointerMapFind(map, key, &found);
+    if (!found) {
+        return NO;
+    }
+    // Backward-shift: pull later entries of the probe run into the hole unless their home slot lies
+    // cyclically in (hole, index].
+    size_t index = hole;
+    while (YES) {
+        index = (index + 1) & map->mask;
+        const void *candidate = map->keys[index];
+        if (!candidate) {
+            break;
+        }
+        size_t home = GrowingULPointerHash(candidate) & map->mask;
+        BOOL stays = (hole <= index) ? (hole < home && home <= index) : (hole < home || home <= index);
+        if (stays) {
+            continue;
+        }
+        map->keys[hole] = candidate;
+        memcpy(GrowingULPointerMapValueAt(map, hole), GrowingULPointerMapValueAt(map, index), map->valueSize);
+        hole = index;
+    }
+    map->keys[hole] = NULL;
+    map->count--;
+    return YES;
+}
+
+void GrowingULPointerMapRemoveAll(GrowingULPointerMap *map) {
+    memset(map->keys, 0, (map->mask + 1) * sizeof(void *));
+    map->count = 0;
+}
+
+void GrowingULPointerMapEnumerate(const GrowingULPointerMap *map,
+                                  void (NS_NOESCAPE ^block)(const void *key, void *value, BOOL *stop)) {
+    BOOL stop = NO;
+    for (size_t i = 0; i <= map->mask && !stop; i++) {
+        if (map->keys[i]) {
+            block(map->keys[i], GrowingULPointerMapValueAt(map, i), &stop);
+        }
+    }
+}
@@ -0,0 +1,44 @@
+//
+//  GrowingULRunLoopIdle.m
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingULRunLoopIdle.h"
+#import <TargetConditionals.h>
+
+void GrowingULPerformWhenMainRunLoopIdle(dispatch_block_t block) {
+#if TARGET_OS_MAC
+    dispatch_block_t schedule = ^{
+        // ordered after the Core Animation commit observer, whose order is 2000000
+        CFRunLoopObserverRef observer = CFRunLoopObserverCreateWithHandler(
+            kCFAllocatorDefault, kCFRunLoopBeforeWaiting, false, LONG_MAX,
+            ^(CFRunLoopObserverRef observer, CFRunLoopActivity activity) {
+                block();
+            });
+        CFRunLoopAddObserver(CFRunLoopGetMain(), observer, kCFRunLoopCommonModes);
+        CFRelease(observer);
+    };
+    if (NSThread.isMainThread) {
+        schedule();
+    } else {
+        dispatch_async(dispatch_get_main_queue(), schedule);
+    }
+#else
+    // no CFRunLoop observers in headless builds
+    dispatch_async(dispatch_get_main_queue(), block);
+#endif
+}
@@ -18,8 +18,14 @@
 //  limitations under the License.
 
 #import "GrowingTargetConditionals.h"
+#import "GrowingULLifecycleEvent.h"
+#import "GrowingULLatencyHistogram.h"
+#import "GrowingULLaunchTimeline.h"
+#import "GrowingULEventJournal.h"
+#import "GrowingULStallMonitor.h"
+#import "GrowingULSceneStateAggregator.h"
 
-@protocol GrowingULAppLifecycleDelegate <NSObject>
+@protocol GrowingULAppLifecycleDelegate <GrowingULLifecycleEventDelegate>
 
 @optional
 - (void)applicationDidFinishLaunching:(NSDictionary *)userInfo;
@@ -34,6 +40,16 @@
 
 - (void)applicationWillEnterForeground;
 
+/// Called once per process, after the first didBecomeActive and, when GrowingULViewControllerLifecycle is set up, the
+/// first viewDidAppear:. timeline is only valid for the duration of the call; see also GrowingULCurrentLaunchTimeline.
+- (void)applicationDidCompleteLaunch:(const GrowingULLaunchTimeline *)timeline;
+
+/// Called for every scene lifecycle notification, before the application callbacks it causes. With several scenes
+/// the application callbacks only follow the aggregate state: the first scene entering the foreground, the first
+/// becoming active, the last resigning active, the last entering the background. event is only valid for the
+/// duration of the call.
+- (void)applicationSceneDidTransition:(const GrowingULSceneEvent *)event;
+
 @end
 
 @interface GrowingULAppLifecycle : NSObject
@@ -43,13 +59,39 @@
 @property (nonatomic, assign) double appDidBecomeActiveTime;
 @property (nonatomic, assign) double appDidEnterBackgroundTime;
 @property (nonatomic, assign) double appWillResignActiveTime;
+/// Defaults to GrowingULLifecycleDeliveryModeSynchronous.
+@property (nonatomic, assign) GrowingULLifecycleDeliveryMode deliveryMode;
+/// Events asynchronous delegates missed because they fell behind by more than the delivery ring holds.
+@property (nonatomic, assign, readonly) NSUInteger droppedEventCount;
+/// Times every delegate callback; see -delegateLatencySnapshot. Off by default.
+@property (nonatomic, assign, getter=isLatencyInstrumentationEnabled) BOOL latencyInstrumentationEnabled;
+/// Receives every event observed, with the time it was observed. Set it before setup.
+@property (nonatomic, strong) GrowingULEventJournal *eventJournal;
+/// Told about every event observed, so that its stalls name the last one.
+@property (nonatomic, strong) GrowingULStallMonitor *stallMonitor;
+/// Mode of the first setup call.
+@property (nonatomic, assign, readonly) GrowingULSetupMode setupMode;
+/// GrowingULMonotonicTimeNanos() spent in the first setup call, that is on the caller's launch path.
+@property (nonatomic, assign, readonly) uint64_t setupNanos;
+/// Time spent completing a staged setup on the first idle run loop pass, replay included; 0 for immediate setups.
+@property (nonatomic, assign, readonly) uint64_t deferredSetupNanos;
+/// +[GrowingULTimeUtil currentSystemTimeMillis] when every observer was installed, 0 before.
+@property (nonatomic, assign, readonly) double setupCompletedTime;
 
 + (instancetype)sharedInstance;
 
+/// Same as +setupWithMode:GrowingULSetupModeImmediate.
 + (void)setup;
 
+/// Only the first call sets up; an immediate setup after a staged one completes it right away.
++ (void)setupWithMode:(GrowingULSetupMode)mode;
+
+/// Delegates are held weakly and may remove themselves from -dealloc.
 - (void)addAppLifecycleDelegate:(id<GrowingULAppLifecycleDelegate>)delegate;
 
 - (void)removeAppLifecycleDelegate:(id<GrowingULAppLifecycleDelegate>)delegate;
 
+/// Per delegate class and callback latency recorded while latencyInstrumentationEnabled was YES.
+- (NSArray<GrowingULDelegateLatency *> *)delegateLatencySnapshot;
+
 @end
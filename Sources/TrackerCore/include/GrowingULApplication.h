@@ -26,8 +26,43 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+typedef NS_ENUM(uint8_t, GrowingULUIFramework) {
+    GrowingULUIFrameworkNone = 0,
+    GrowingULUIFrameworkUIKit,
+    GrowingULUIFrameworkAppKit,
+    GrowingULUIFrameworkWatchKit,
+};
+
+/// Runtime facts resolved once instead of per call.
+typedef struct {
+    /// NSApplication, UIApplication or WKApplication, Nil if not linked
+    __unsafe_unretained Class _Nullable applicationClass;
+    /// +sharedApplication of applicationClass, looked up again on every call while it is still nil
+    __unsafe_unretained id _Nullable application;
+    GrowingULUIFramework framework;
+    BOOL isAppExtension;
+    /// Info.plist declares UIApplicationSceneManifest
+    BOOL hasSceneManifest;
+    /// the scene manifest is present and the system supports scenes, lifecycle notifications come from UIScene
+    BOOL usesSceneLifecycle;
+    /// NO until geometry was read on the main thread
+    BOOL hasGeometry;
+    /// status bar height of the key window's scene, 0 where there is no status bar
+    CGFloat statusBarHeight;
+    /// main screen bounds and scale, 0 where there is no main screen
+    CGSize screenSize;
+    CGFloat screenScale;
+} GrowingULEnvironment;
+
+/// Returns a consistent copy of the current snapshot; callable from any thread without taking a lock.
+FOUNDATION_EXPORT GrowingULEnvironment GrowingULCurrentEnvironment(void);
+
 @interface GrowingULApplication : NSObject
 
+/// Builds the environment snapshot and starts refreshing its geometry on status bar, orientation, screen, window
+/// and scene notifications. Called by +[GrowingULAppLifecycle setup]; the snapshot is also built on first use.
++ (void)setup;
+
 + (nullable id)sharedApplication;
 
 + (BOOL)isAppExtension;
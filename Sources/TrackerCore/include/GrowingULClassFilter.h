@@ -0,0 +1,53 @@
+//
+//  GrowingULClassFilter.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Include/exclude predicate on classes, used to limit which objects a lifecycle delegate is called for.
+
+ A class is rejected if it matches any exclusion; otherwise it is accepted if there are no inclusions or it matches
+ one of them. Class rules also match subclasses, prefixes are matched against the class' own name and bundle rules
+ against +[NSBundle bundleForClass:].
+
+ Configure a filter before registering it; registration takes a copy, and the verdict for each class is evaluated
+ once and cached by the registry.
+ */
+@interface GrowingULClassFilter : NSObject <NSCopying>
+
+/// Accepts only classes of the main bundle, which leaves out UIKit's own controllers
+/// (UIInputWindowController, UICompatibilityInputViewController, alert internals...).
++ (instancetype)mainBundleFilter;
+
+- (void)includeClass:(Class)cls;
+- (void)excludeClass:(Class)cls;
+
+- (void)includeClassPrefix:(NSString *)prefix;
+- (void)excludeClassPrefix:(NSString *)prefix;
+
+- (void)includeBundle:(NSBundle *)bundle;
+- (void)excludeBundle:(NSBundle *)bundle;
+
+- (BOOL)acceptsClass:(Class)cls;
+
+@end
+
+NS_ASSUME_NONNULL_END
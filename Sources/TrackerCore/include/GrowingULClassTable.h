@@ -0,0 +1,54 @@
+//
+//  GrowingULClassTable.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Compact, process-wide id of an interned class; 0 stands for no class.
+typedef uint32_t GrowingULClassId;
+
+/*
+ Interning table of classes seen by the lifecycle hubs: each class gets a dense id and an immutable name, built on
+ first sight and kept for the lifetime of the process. Names returned here are never released, so they may be
+ held __unsafe_unretained, and reading them does not allocate.
+
+ Id lookups are lock-free; interning takes a private lock, shortly.
+ */
+
+/// Interns cls if needed and returns its id; 0 for Nil or once the table is full.
+FOUNDATION_EXPORT GrowingULClassId GrowingULClassIdForClass(Class _Nullable cls);
+
+/// Interned name of classId, nil for ids not handed out.
+FOUNDATION_EXPORT NSString *_Nullable GrowingULClassNameForId(GrowingULClassId classId);
+
+FOUNDATION_EXPORT Class _Nullable GrowingULClassForId(GrowingULClassId classId);
+
+/// Same as NSStringFromClass, without its allocation after the first call for a class.
+FOUNDATION_EXPORT NSString *_Nullable GrowingULClassNameForClass(Class _Nullable cls);
+
+/// Bulk GrowingULClassNameForId, filling names[i] for ids[i].
+FOUNDATION_EXPORT void GrowingULClassNamesForIds(const GrowingULClassId *ids,
+                                                 NSUInteger count,
+                                                 NSString *__unsafe_unretained _Nullable *_Nonnull names);
+
+/// Number of classes interned so far; ids run from 1 to this count.
+FOUNDATION_EXPORT NSUInteger GrowingULClassTableCount(void);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,106 @@
+//
+//  GrowingULDelegateRegistry.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingULLifecycleEvent.h"
+#import "GrowingULLatencyHistogram.h"
+#import "GrowingULClassFilter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Audience masks select the delegates a dispatch reaches: each filtered delegate owns one bit, all unfiltered
+/// delegates share GrowingULDelegateAudienceUnfiltered.
+static const uint64_t GrowingULDelegateAudienceUnfiltered = 1ULL << 63;
+static const uint64_t GrowingULDelegateAudienceAll = UINT64_MAX;
+
+/**
+ Copy-on-write registry of lifecycle delegates.
+
+ Registration resolves every callback selector of the delegate once, into a capability bitmask and cached IMPs.
+ Every add/remove then rebuilds an immutable snapshot that holds, for each selector, only the delegates
+ implementing it. Dispatch pins the current snapshot and calls the cached IMPs from a plain array: no lock,
+ no respondsToSelector:, no message lookup and no retain per event. A delegate that has changed class since it was
+ added (KVO, isa swizzling) is called through its current class instead.
+
+ @note Delegates are held weakly, deallocated ones are pruned on the next add or remove. A delegate may remove
+ itself from -dealloc. Since calls do not retain the delegate, removing it, or releasing it for the last time, waits
+ for the calls into it that are running on other threads; a callback must not wait for the thread doing that.
+ */
+@interface GrowingULDelegateRegistry : NSObject
+
+/// When YES, delegates accepting asynchronous events (see GrowingULLifecycleDeliveryModeAsynchronous) are left out
+/// of the per-selector dispatch and receive posted events on a serial background queue instead.
+@property (atomic, assign) BOOL asynchronousDelivery;
+
+/// When YES, delegates implementing -lifecycleDidReceiveEvents:count: are left out of the per-selector dispatch and
+/// only receive the batches passed to -dispatchEvents:count:.
+@property (atomic, assign) BOOL batchedDelivery;
+
+/// When YES, every delegate callback is timed with the monotonic clock into a histogram per delegate class and
+/// callback. Recording takes no lock.
+@property (atomic, assign, getter=isLatencyInstrumentationEnabled) BOOL latencyInstrumentationEnabled;
+
+/// At most 64 selectors, one capability bit each.
+- (instancetype)initWithSelectors:(const SEL _Nonnull *_Nonnull)selectors
+                            count:(NSUInteger)count NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (void)addDelegate:(id)delegate;
+
+/// Registers delegate to be called only for classes accepted by filter (a copy is kept), see -audienceForClass:.
+/// Application events, which carry no class, reach every delegate. At most 63 delegates can be filtered.
+- (void)addDelegate:(id)delegate classFilter:(nullable GrowingULClassFilter *)filter;
+
+- (void)removeDelegate:(id)delegate;
+
+/// Bit i is set when the delegate implements selectors[i]; 0 if the delegate is not registered.
+- (uint64_t)capabilitiesOfDelegate:(id)delegate;
+
+/// Sends selectors[index] to every delegate implementing it, in registration order.
+- (void)dispatchSelectorAtIndex:(NSUInteger)index;
+
+/// Sends selectors[index] with object to every delegate implementing it, in registration order.
+- (void)dispatchSelectorAtIndex:(NSUInteger)index withObject:(nullable id)object;
+
+/// Sends selectors[index] with a pointer argument to every delegate implementing it, in registration order.
+- (void)dispatchSelectorAtIndex:(NSUInteger)index withPointer:(const void *)pointer;
+
+/// Audience mask of the delegates that accept cls, 0 if no delegate would be called for it. Filters are evaluated
+/// once per class; cached verdicts are read without a lock, and not at all while no delegate is filtered.
+/// Asynchronous and batched events are filtered by their objectClass the same way.
+- (uint64_t)audienceForClass:(nullable Class)cls;
+
+- (void)dispatchSelectorAtIndex:(NSUInteger)index withObject:(nullable id)object audience:(uint64_t)audience;
+
+- (void)dispatchSelectorAtIndex:(NSUInteger)index withPointer:(const void *)pointer audience:(uint64_t)audience;
+
+/// Hands a batch of events to the batch delegates, synchronously on the calling thread.
+- (void)dispatchEvents:(const GrowingULLifecycleEvent *)events count:(NSUInteger)count;
+
+/// Queues the event for asynchronous delegates; does nothing unless asynchronousDelivery is YES.
+- (void)postEvent:(GrowingULLifecycleEvent)event;
+
+/// Posted events dropped because the asynchronous delivery ring was full.
+- (NSUInteger)droppedEventCount;
+
+/// Callbacks recorded so far, one entry per delegate class and callback with at least one sample.
+- (NSArray<GrowingULDelegateLatency *> *)latencySnapshot;
+
+@end
+
+NS_ASSUME_NONNULL_END
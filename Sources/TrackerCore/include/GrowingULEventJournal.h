@@ -0,0 +1,91 @@
+//
+//  GrowingULEventJournal.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import "GrowingULLifecycleEvent.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Record type written once per process when the journal is opened. Its timestamp has the base of the session's
+/// events, its instanceId is the wall clock in milliseconds since 1970 at that instant and its classId the process id.
+static const GrowingULLifecycleEventType GrowingULJournalRecordTypeSessionStart = UINT16_MAX;
+
+/**
+ One journal entry, 32 bytes on disk.
+
+ GrowingULJournalRecordTypeSessionStart records reuse the fields of event records rather than having a layout of
+ their own: instanceId holds the wall clock in milliseconds since 1970 and classId the process id, which is not a
+ class id and must not be passed to -classNameForId:.
+ */
+typedef struct {
+    /// 1-based and increasing across sessions
+    uint64_t sequence;
+    /// GrowingULLifecycleEvent.timestamp, only comparable within a session
+    double timestamp;
+    /// address of the view controller, unique among the controllers alive at the same time; 0 for application events;
+    /// the wall clock in milliseconds for GrowingULJournalRecordTypeSessionStart
+    uint64_t instanceId;
+    /// see -classNameForId:; 0 for application events and for classes that did not fit in the file; the process id
+    /// for GrowingULJournalRecordTypeSessionStart
+    uint32_t classId;
+    GrowingULLifecycleEventType type;
+    uint16_t reserved;
+} GrowingULJournalRecord;
+
+/**
+ Append-only ring of fixed-size lifecycle records in a memory-mapped file.
+
+ Appending reserves a slot with one atomic increment and writes the record into the mapping: no syscall and no
+ allocation; view controller events take a short lock to map their GrowingULClassId to the journal's class id. The
+ mapping is shared with the kernel's page cache, so records written before the process is killed or crashes are
+ kept; only a power loss can drop the last ones. Each record is committed by storing its sequence last, which lets
+ a reader skip a record torn by a crash. A writer claims its slot with a CAS on that sequence: a writer that has
+ lapped the ring never fills a record together with a slower one, and a record older than the slot's drops itself.
+
+ Class names live in a separate section of the file and are written once; their ids stay stable across sessions.
+ When the section is more than half full at open, the names no recovered record refers to are dropped.
+ */
+@interface GrowingULEventJournal : NSObject
+
+@property (nonatomic, copy, readonly) NSString *path;
+/// Number of records the ring holds before overwriting the oldest.
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+
+/// A journal with 4096 records in Application Support, created on first use; nil if it cannot be opened.
++ (nullable instancetype)defaultJournal;
+
+/// Opens the journal at path, creating or resetting it if it is missing, of another layout or of another capacity.
+/// The records found are available through -enumerateRecoveredRecordsUsingBlock:.
+- (nullable instancetype)initWithPath:(NSString *)path
+                             capacity:(NSUInteger)capacity
+                                error:(NSError **)error NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (void)appendEvent:(const GrowingULLifecycleEvent *)event;
+
+/// Visits, oldest first, the records that were in the file when it was opened, i.e. those of previous sessions.
+- (void)enumerateRecoveredRecordsUsingBlock:(void (NS_NOESCAPE ^)(const GrowingULJournalRecord *record,
+                                                                  BOOL *stop))block;
+
+/// Name of a class id found in a record, of this or a previous session.
+- (nullable NSString *)classNameForId:(uint32_t)classId;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,61 @@
+//
+//  GrowingULLatencyHistogram.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef struct {
+    uint64_t count;
+    uint64_t p50Nanos;
+    uint64_t p99Nanos;
+    uint64_t maxNanos;
+} GrowingULLatencySummary;
+
+/**
+ Fixed-size log-linear histogram of nanosecond durations: 8 linear sub-buckets per power of two, so a reported
+ percentile is within 12.5% of the recorded value; durations above ~30 minutes fall into the last bucket.
+
+ Recording is lock-free (relaxed atomic increments) and may run concurrently with summarizing.
+ */
+typedef struct GrowingULLatencyHistogram GrowingULLatencyHistogram;
+
+FOUNDATION_EXPORT GrowingULLatencyHistogram *GrowingULLatencyHistogramCreate(void);
+
+FOUNDATION_EXPORT void GrowingULLatencyHistogramDestroy(GrowingULLatencyHistogram *histogram);
+
+FOUNDATION_EXPORT void GrowingULLatencyHistogramRecord(GrowingULLatencyHistogram *histogram, uint64_t nanos);
+
+FOUNDATION_EXPORT GrowingULLatencySummary GrowingULLatencyHistogramSummarize(const GrowingULLatencyHistogram *histogram);
+
+/// Latency of one callback of one delegate class, see -delegateLatencySnapshot of the lifecycle hubs.
+@interface GrowingULDelegateLatency : NSObject
+
+@property (nonatomic, unsafe_unretained, readonly) Class delegateClass;
+@property (nonatomic, assign, readonly) SEL selector;
+@property (nonatomic, assign, readonly) GrowingULLatencySummary summary;
+
+- (instancetype)initWithDelegateClass:(Class)delegateClass
+                             selector:(SEL)selector
+                              summary:(GrowingULLatencySummary)summary NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
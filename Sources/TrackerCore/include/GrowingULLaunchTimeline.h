@@ -0,0 +1,68 @@
+//
+//  GrowingULLaunchTimeline.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, GrowingULLaunchType) {
+    GrowingULLaunchTypeUnknown = 0,
+    /// first launch of this app version since the device booted
+    GrowingULLaunchTypeCold,
+    /// launched before in this boot session, the binary is likely still in the page cache
+    GrowingULLaunchTypeWarm,
+    /// the system started the process ahead of time (ActivePrewarm); pre-main ran long before the user launched
+    GrowingULLaunchTypePrewarmed,
+    /// the system launched the process in the background (fetch, push, location); didBecomeActive came with a later
+    /// user launch, so the milestones do not measure a launch
+    GrowingULLaunchTypeBackground,
+};
+
+/// Milestones of the process launch, all on the +[GrowingULTimeUtil currentSystemTimeMillis] base; 0 when not seen.
+typedef struct {
+    GrowingULLaunchType type;
+    /// process creation from the kernel's process info; derived from the wall clock, so it includes time asleep
+    double processStartTime;
+    /// TrackerCore's static initializer, the earliest pre-main point the library runs at
+    double initializerTime;
+    double didFinishLaunchingTime;
+    /// first viewDidAppear: seen by GrowingULViewControllerLifecycle
+    double firstPageAppearTime;
+    /// first didBecomeActive, of the application or of a scene
+    double didBecomeActiveTime;
+} GrowingULLaunchTimeline;
+
+/// Copies the timeline recorded so far; returns YES once it is complete, that is after the first didBecomeActive and,
+/// when a page appearance is expected, the first viewDidAppear:.
+FOUNDATION_EXPORT BOOL GrowingULCurrentLaunchTimeline(GrowingULLaunchTimeline *timeline);
+
+/// Makes completion wait for the first viewDidAppear:; called when GrowingULViewControllerLifecycle is set up.
+FOUNDATION_EXPORT void GrowingULLaunchTimelineExpectPageAppearance(void);
+
+/// Milestone recorders for the lifecycle hubs; only the first call of each is kept. time is on the
+/// +[GrowingULTimeUtil currentSystemTimeMillis] base.
+FOUNDATION_EXPORT void GrowingULLaunchTimelineRecordDidFinishLaunching(double time);
+FOUNDATION_EXPORT void GrowingULLaunchTimelineRecordDidBecomeActive(double time);
+FOUNDATION_EXPORT void GrowingULLaunchTimelineRecordPageAppearance(double time);
+
+/// Called by GrowingULAppLifecycle when the application is still in the background after didFinishLaunching; has no
+/// effect on a prewarmed or completed launch.
+FOUNDATION_EXPORT void GrowingULLaunchTimelineMarkBackgroundLaunch(void);
+
+NS_ASSUME_NONNULL_END
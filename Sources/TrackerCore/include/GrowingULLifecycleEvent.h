@@ -0,0 +1,91 @@
+//
+//  GrowingULLifecycleEvent.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import "GrowingULClassTable.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(uint16_t, GrowingULLifecycleEventType) {
+    GrowingULLifecycleEventTypeUnknown = 0,
+    GrowingULLifecycleEventTypeApplicationDidFinishLaunching,
+    GrowingULLifecycleEventTypeApplicationWillTerminate,
+    GrowingULLifecycleEventTypeApplicationDidBecomeActive,
+    GrowingULLifecycleEventTypeApplicationWillResignActive,
+    GrowingULLifecycleEventTypeApplicationDidEnterBackground,
+    GrowingULLifecycleEventTypeApplicationWillEnterForeground,
+    GrowingULLifecycleEventTypeViewControllerLoadView,
+    GrowingULLifecycleEventTypeViewControllerDidLoad,
+    GrowingULLifecycleEventTypeViewControllerWillAppear,
+    GrowingULLifecycleEventTypeViewControllerIsAppearing,
+    GrowingULLifecycleEventTypeViewControllerDidAppear,
+    GrowingULLifecycleEventTypeViewControllerWillDisappear,
+    GrowingULLifecycleEventTypeViewControllerDidDisappear,
+};
+
+/// Compact record of one lifecycle transition, captured on the thread that observed it.
+typedef struct {
+    GrowingULLifecycleEventType type;
+    /// interned id of objectClass, 0 for application events
+    GrowingULClassId classId;
+    /// +[GrowingULTimeUtil currentSystemTimeMillis] at capture time
+    double timestamp;
+    /// class of the view controller, Nil for application events
+    __unsafe_unretained Class _Nullable objectClass;
+    /// interned name of objectClass, valid for the lifetime of the process; nil for application events
+    __unsafe_unretained NSString *_Nullable objectClassName;
+    /// address of the view controller, for identity only; never dereference it off the main thread
+    const void *_Nullable objectIdentity;
+} GrowingULLifecycleEvent;
+
+typedef NS_ENUM(NSInteger, GrowingULLifecycleDeliveryMode) {
+    /// Every delegate is called synchronously on the thread that observed the transition.
+    GrowingULLifecycleDeliveryModeSynchronous = 0,
+    /// Delegates that implement -lifecycleDidReceiveEvent: and return NO from -lifecycleDelegateRequiresMainThread
+    /// receive GrowingULLifecycleEvent records in order on a serial background queue instead of the per-callback
+    /// methods. All other delegates are still called synchronously.
+    GrowingULLifecycleDeliveryModeAsynchronous = 1,
+};
+
+typedef NS_ENUM(NSInteger, GrowingULSetupMode) {
+    /// Every hook and observer is installed before setup returns.
+    GrowingULSetupModeImmediate = 0,
+    /// Only what the first events need is installed before setup returns; the rest is installed on the first idle
+    /// pass of the main run loop. Events observed until then are buffered and delivered to the delegates, in order
+    /// and with their original timestamps, once everything is installed. Setup must be called on the main thread.
+    GrowingULSetupModeStaged = 1,
+};
+
+@protocol GrowingULLifecycleEventDelegate <NSObject>
+
+@optional
+/// Read once when the delegate is added. Treated as YES when not implemented.
+- (BOOL)lifecycleDelegateRequiresMainThread;
+
+/// Called on a serial background queue in GrowingULLifecycleDeliveryModeAsynchronous.
+- (void)lifecycleDidReceiveEvent:(GrowingULLifecycleEvent)event;
+
+/// Called on the main thread with the events coalesced by a batching hub, in the order they happened. While batching
+/// is enabled the per-callback methods are not called. The objects behind objectIdentity are alive for the duration
+/// of the call.
+- (void)lifecycleDidReceiveEvents:(const GrowingULLifecycleEvent *)events count:(NSUInteger)count;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,46 @@
+//
+//  GrowingULLifecycleEventQueue.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingULLifecycleEvent.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void (^GrowingULLifecycleEventHandler)(GrowingULLifecycleEvent event);
+
+/**
+ Bounded multi-producer/single-consumer ring of lifecycle events, drained in order on a serial queue.
+
+ Events enqueued from any thread go through the same ring and are handled in the order they were enqueued in;
+ enqueueing takes no lock. When the ring is full the event is dropped and counted.
+ */
+@interface GrowingULLifecycleEventQueue : NSObject
+
+@property (nonatomic, assign, readonly) NSUInteger droppedEventCount;
+
+/// capacity is rounded up to a power of two
+- (instancetype)initWithLabel:(const char *)label
+                     capacity:(NSUInteger)capacity
+                      handler:(GrowingULLifecycleEventHandler)handler NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (void)enqueueEvent:(GrowingULLifecycleEvent)event;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,56 @@
+//
+//  GrowingULPointerMap.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Open-addressing hash table keyed by pointer identity, with fixed-size values stored inline.
+
+ Linear probing over a power-of-two table, backward-shift deletion (no tombstones). Keys are compared by address
+ and never retained; NULL is not a valid key. Not thread-safe, callers serialize access.
+
+ @note Value pointers returned by the functions below are invalidated by the next insertion or removal.
+ */
+typedef struct GrowingULPointerMap GrowingULPointerMap;
+
+FOUNDATION_EXPORT GrowingULPointerMap *GrowingULPointerMapCreate(size_t valueSize);
+
+FOUNDATION_EXPORT void GrowingULPointerMapDestroy(GrowingULPointerMap *map);
+
+FOUNDATION_EXPORT NSUInteger GrowingULPointerMapCount(const GrowingULPointerMap *map);
+
+/// Returns the value stored for key, or NULL.
+FOUNDATION_EXPORT void *_Nullable GrowingULPointerMapGet(const GrowingULPointerMap *map, const void *key);
+
+/// Returns the value stored for key, inserting a zero-filled one first if needed.
+FOUNDATION_EXPORT void *GrowingULPointerMapGetOrInsert(GrowingULPointerMap *map,
+                                                       const void *key,
+                                                       BOOL *_Nullable inserted);
+
+FOUNDATION_EXPORT BOOL GrowingULPointerMapRemove(GrowingULPointerMap *map, const void *key);
+
+FOUNDATION_EXPORT void GrowingULPointerMapRemoveAll(GrowingULPointerMap *map);
+
+/// Visits every entry; the map must not be mutated from the block.
+FOUNDATION_EXPORT void GrowingULPointerMapEnumerate(const GrowingULPointerMap *map,
+                                                    void (NS_NOESCAPE ^block)(const void *key, void *value, BOOL *stop));
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,28 @@
+//
+//  GrowingULRunLoopIdle.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Runs block once on the main thread, the next time the main run loop is about to wait, that is after the work of
+/// the current pass including Core Animation's commit. Used to move setup work off the launch path.
+FOUNDATION_EXPORT void GrowingULPerformWhenMainRunLoopIdle(dispatch_block_t block);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,85 @@
+//
+//  GrowingULSceneStateAggregator.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import "GrowingULLifecycleEvent.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(uint8_t, GrowingULSceneActivationState) {
+    /// not connected, or disconnected
+    GrowingULSceneActivationStateUnattached = 0,
+    GrowingULSceneActivationStateBackground,
+    GrowingULSceneActivationStateForegroundInactive,
+    GrowingULSceneActivationStateForegroundActive,
+};
+
+/// One scene lifecycle notification.
+typedef NS_ENUM(uint8_t, GrowingULSceneTransition) {
+    GrowingULSceneTransitionWillConnect = 0,
+    GrowingULSceneTransitionWillEnterForeground,
+    GrowingULSceneTransitionDidActivate,
+    GrowingULSceneTransitionWillDeactivate,
+    GrowingULSceneTransitionDidEnterBackground,
+    GrowingULSceneTransitionDidDisconnect,
+};
+
+/// Most application events a single scene transition can cause.
+static const NSUInteger GrowingULSceneTransitionMaxApplicationEvents = 2;
+
+/// A transition of one scene, delivered on the per-scene channel of GrowingULAppLifecycle.
+typedef struct {
+    /// the UIScene, for identity and main-thread use during the call
+    __unsafe_unretained id scene;
+    GrowingULSceneTransition transition;
+    GrowingULSceneActivationState previousState;
+    GrowingULSceneActivationState state;
+    /// +[GrowingULTimeUtil currentSystemTimeMillis] of the notification
+    double timestamp;
+} GrowingULSceneEvent;
+
+/**
+ Folds the activation states of every connected scene into one application state: active while any scene is
+ active, in the foreground while any scene is, in the background otherwise.
+
+ Transitions are looked up in tables, and the application events returned are those of the aggregate moving, so a
+ second window becoming active does not report the application becoming active again. Main thread only.
+ */
+@interface GrowingULSceneStateAggregator : NSObject
+
+/// Background before any scene connected or was seeded.
+@property (nonatomic, assign, readonly) GrowingULSceneActivationState applicationState;
+@property (nonatomic, assign, readonly) NSUInteger sceneCount;
+
+- (GrowingULSceneActivationState)stateOfScene:(const void *)scene;
+
+/// Moves scene to the state transition leads to. Writes the application events caused, in order, to events, which
+/// must hold GrowingULSceneTransitionMaxApplicationEvents, and returns their count.
+- (NSUInteger)applyTransition:(GrowingULSceneTransition)transition
+                      toScene:(const void *)scene
+                previousState:(nullable GrowingULSceneActivationState *)previousState
+                       events:(GrowingULLifecycleEventType *)events;
+
+/// Records the state of a scene that connected before its notifications were observed, moving the application state
+/// without reporting events; ignored for a scene already known and for the unattached state.
+- (void)seedScene:(const void *)scene state:(GrowingULSceneActivationState)state;
+
+@end
+
+NS_ASSUME_NONNULL_END
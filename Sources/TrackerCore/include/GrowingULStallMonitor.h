@@ -0,0 +1,104 @@
+//
+//  GrowingULStallMonitor.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+
+#import <Foundation/Foundation.h>
+#import "GrowingULLifecycleEvent.h"
+#import "GrowingULLatencyHistogram.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Most thresholds a monitor reports; longer ones are ignored.
+static const NSUInteger GrowingULStallMaxThresholds = 8;
+
+/// One main run loop iteration that ran longer than the shortest of the monitor's thresholds.
+typedef struct {
+    /// GrowingULMonotonicTimeNanos() of the first sample that saw the iteration
+    uint64_t startNanos;
+    /// time the iteration has run so far, to within one sampling interval; final in -stallMonitor:didEndStall:
+    uint64_t durationNanos;
+    /// class of the top view controller when the stall was detected, 0 if none was tracked
+    GrowingULClassId pageClassId;
+    /// last lifecycle event dispatched before the stall was detected, GrowingULLifecycleEventTypeUnknown if none
+    GrowingULLifecycleEventType lastEventType;
+    /// class of the controller of lastEventType, 0 for application events
+    GrowingULClassId lastEventClassId;
+    /// index in the monitor's thresholds of the longest one the iteration has reached
+    uint32_t thresholdIndex;
+    uint64_t thresholdNanos;
+} GrowingULStall;
+
+@class GrowingULStallMonitor;
+
+/// Called on the monitor's background queue, in order; stall is only valid for the duration of the call.
+@protocol GrowingULStallMonitorDelegate <NSObject>
+
+@optional
+/// The iteration has reached stall->thresholdNanos and may still be running; called once for every threshold reached,
+/// shortest first. A process killed by a watchdog never gets to -stallMonitor:didEndStall:.
+- (void)stallMonitor:(GrowingULStallMonitor *)monitor didDetectStall:(const GrowingULStall *)stall;
+
+/// The stalled iteration returned; its duration was recorded in the histogram of its page. Called once per stall,
+/// with the longest threshold reached.
+- (void)stallMonitor:(GrowingULStallMonitor *)monitor didEndStall:(const GrowingULStall *)stall;
+
+@end
+
+/**
+ Watchdog of the main run loop.
+
+ A run loop observer stores an iteration counter, one relaxed store per activity and no clock read; a timer on a
+ background queue samples it four times per shortest threshold and only does work once the counter stops moving while
+ the main thread is not waiting. Stalls are attributed to the page and the last event the lifecycle hubs publish through
+ -setPageClassId: and -recordEvent:, see their stallMonitor property.
+
+ Time the sampler itself could not run (the process was suspended) is not counted. Without CFRunLoop (headless
+ builds) -start does nothing.
+ */
+@interface GrowingULStallMonitor : NSObject
+
+@property (atomic, weak, nullable) id<GrowingULStallMonitorDelegate> delegate;
+
+/// Stall durations reported, in seconds; defaults to @[@0.25] and an empty array restores it. Kept in increasing order
+/// without duplicates, values under 0.01 are raised to it. Read by -start.
+@property (nonatomic, copy) NSArray<NSNumber *> *thresholds;
+
+@property (nonatomic, assign, readonly, getter=isRunning) BOOL running;
+
+/// Observes the main run loop in its common modes and starts sampling; the observer is added on the main thread.
+- (void)start;
+
+- (void)stop;
+
+/// Remembers the page stalls are attributed to. Any thread.
+- (void)setPageClassId:(GrowingULClassId)pageClassId;
+
+/// Remembers the type and class of event as the last one dispatched. Any thread.
+- (void)recordEvent:(const GrowingULLifecycleEvent *)event;
+
+/// Durations of the ended stalls of a page; pageClassId 0 holds the stalls without a page.
+- (GrowingULLatencySummary)stallSummaryForPageClassId:(GrowingULClassId)pageClassId;
+
+/// Visits every page with at least one ended stall.
+- (void)enumerateStallSummariesUsingBlock:(void (NS_NOESCAPE ^)(GrowingULClassId pageClassId,
+                                                                GrowingULLatencySummary summary))block;
+
+@end
+
+NS_ASSUME_NONNULL_END
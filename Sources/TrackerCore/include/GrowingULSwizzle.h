@@ -41,9 +41,42 @@
 //  limitations under the License.
 
 #import <Foundation/Foundation.h>
+#import "GrowingULSwizzleHook.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
+typedef NS_ENUM(NSInteger, GrowingULSwizzleEntryResult) {
+    GrowingULSwizzleEntryResultNotInstalled = 0,
+    GrowingULSwizzleEntryResultInstalled,
+    GrowingULSwizzleEntryResultOriginalNotFound,
+    GrowingULSwizzleEntryResultReplacementNotFound,
+    /// the same selector appears in more than one entry for the class
+    GrowingULSwizzleEntryResultDuplicate,
+};
+
+/// One exchange of GrowingULSwizzleMethods, with the same semantics as +growingul_swizzleMethod:withMethod:error:.
+typedef struct {
+    __unsafe_unretained Class cls;
+    SEL originalSelector;
+    SEL replacementSelector;
+    /// written by GrowingULSwizzleMethods
+    GrowingULSwizzleEntryResult result;
+    /// written by GrowingULSwizzleMethods when installed; registered hooks live for the life of the process
+    __unsafe_unretained GrowingULSwizzleHook *_Nullable hook;
+} GrowingULSwizzleEntry;
+
+/**
+ Validates every entry first and installs them only if all are valid, so a batch is never applied partially.
+
+ @return YES if every entry was installed; otherwise nothing is installed, the failing entries carry their result
+ and error describes the first of them.
+ */
+FOUNDATION_EXPORT BOOL GrowingULSwizzleMethods(GrowingULSwizzleEntry *entries,
+                                               NSUInteger count,
+                                               NSError **_Nullable error);
+
+/// Every method of this category registers a GrowingULSwizzleHook for the replaced selector, see
+/// +[GrowingULSwizzleHook hookForClass:selector:].
 @interface NSObject (GrowingULSwizzle)
 
 + (BOOL)growingul_swizzleMethod:(SEL)origSel_ withMethod:(SEL)altSel_ error:(NSError **)error_;
@@ -77,6 +110,27 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (nullable NSInvocation *)growingul_swizzleClassMethod:(SEL)origSel withBlock:(id)block error:(NSError **)error;
 
+/**
+ Replaces the implementation of origSel in this class with the block returned by factory, which receives the
+ implementation being replaced (the inherited one if the class did not implement origSel) to call directly. No
+ selector is registered and no NSInvocation is involved, so calling the original costs one function call.
+ ```
+ [self growingul_swizzleMethod:@selector(viewDidAppear:) withBlockFactory:^id(IMP original) {
+     return ^(UIViewController *controller, BOOL animated) {
+         ((void (*)(id, SEL, BOOL))original)(controller, @selector(viewDidAppear:), animated);
+         NSLog(@"after %@", controller);
+     };
+ } error:nil];
+ ```
+ */
++ (BOOL)growingul_swizzleMethod:(SEL)origSel
+               withBlockFactory:(id (^)(IMP original))factory
+                          error:(NSError **)error;
+
++ (BOOL)growingul_swizzleClassMethod:(SEL)origSel
+                    withBlockFactory:(id (^)(IMP original))factory
+                               error:(NSError **)error;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,185 @@
+//
+//  GrowingULSwizzleHook.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, GrowingULSwizzleHookState) {
+    GrowingULSwizzleHookStateActive = 0,
+    /// the original implementation is installed again, calls do not reach the hook
+    GrowingULSwizzleHookStateRestored,
+    /// another hook was stacked on top by method exchange; its alias now points at the original implementation
+    GrowingULSwizzleHookStateBypassed,
+    /// another hook calls the replacement directly, which keeps being called; it should check
+    /// GrowingULSwizzleHooksSuspended() or isSuspended and only call the original
+    GrowingULSwizzleHookStatePassthrough,
+};
+
+/// Calls of one hook and the time they added, summed over every thread.
+typedef struct {
+    uint64_t calls;
+    /// time spent in the hook's own code, without its calls of the original implementation and of nested hooks
+    uint64_t selfNanos;
+} GrowingULSwizzleHookStatistics;
+
+/**
+ Handle on one installed swizzle, returned or registered by every swizzling API of this library.
+
+ Suspending puts the original implementation back when the hook is still the class' implementation, so a suspended
+ hook costs nothing per call. When another library has swizzled the method afterwards, its hook is kept: the
+ alias it exchanged ours into is pointed at the original instead, or, if it holds our implementation directly,
+ the hook falls back to passthrough.
+ */
+@interface GrowingULSwizzleHook : NSObject
+
+@property (nonatomic, unsafe_unretained, readonly) Class hookedClass;
+@property (nonatomic, assign, readonly) SEL selector;
+@property (atomic, assign, readonly) GrowingULSwizzleHookState state;
+@property (atomic, assign, readonly, getter=isSuspended) BOOL suspended;
+/// key passed to +[GrowingULSwizzle swizzleInstanceMethod:inClass:newImpFactory:mode:key:], NULL otherwise
+@property (nonatomic, assign, readonly, nullable) const void *key;
+/// 1-based position in registration order
+@property (nonatomic, assign, readonly) uint32_t index;
+
+/// Counts the calls and self time of hooks entering a GrowingULSwizzleHookEnterScope. Off by default.
+@property (class, nonatomic, assign, getter=isInstrumentationEnabled) BOOL instrumentationEnabled;
+
+/// Registers a hook whose replacement IMP has just been installed for selector in cls. original is the
+/// implementation it replaced, NULL if the method was inherited. Hooks are kept for the life of the process.
++ (instancetype)registerHookForClass:(Class)cls
+                            selector:(SEL)selector
+                         replacement:(IMP)replacement
+                            original:(nullable IMP)original;
+
++ (instancetype)registerHookForClass:(Class)cls
+                            selector:(SEL)selector
+                         replacement:(IMP)replacement
+                            original:(nullable IMP)original
+                                 key:(nullable const void *)key;
+
+/// The most recently registered hook for the selector of cls, if any.
++ (nullable instancetype)hookForClass:(Class)cls selector:(SEL)selector;
+
++ (NSArray<GrowingULSwizzleHook *> *)allHooks;
+
+/// Suspends every registered hook, newest first, so stacked hooks of this library unwind cleanly.
++ (void)suspendAllHooks;
+
+/// Resumes every registered hook, oldest first.
++ (void)resumeAllHooks;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (GrowingULSwizzleHookState)suspend;
+
+/// Returns NO if the hook could not be put back because the method was swizzled again while suspended; it then
+/// stays suspended.
+- (BOOL)resume;
+
+/// Merges the counters of every thread; counts of calls still running on other threads may be missing.
+- (GrowingULSwizzleHookStatistics)statistics;
+
+/// Visits every registered hook, oldest first, with its merged statistics.
++ (void)enumerateStatisticsUsingBlock:(void (NS_NOESCAPE ^)(GrowingULSwizzleHook *hook,
+                                                            GrowingULSwizzleHookStatistics statistics,
+                                                            BOOL *stop))block;
+
+@end
+
+/// YES between +suspendAllHooks and +resumeAllHooks.
+FOUNDATION_EXPORT BOOL GrowingULSwizzleHooksSuspended(void);
+
+/// NO while any hook is suspended, so hooked callbacks may be missed. generation changes whenever a hook is suspended
+/// or resumed: state kept up to date by hooked callbacks is only current while this returns YES with the generation
+/// it was built at.
+FOUNDATION_EXPORT BOOL GrowingULSwizzleHooksActive(uint64_t *_Nullable generation);
+
+#pragma mark - Instrumentation
+
+/*
+ Counters are kept per hook and per thread, written by their thread only and merged when read, so a call costs two
+ clock reads and no atomic read-modify-write. While instrumentation is off, entering a scope is one relaxed load.
+
+ Replacements made with GrowingULSwizzleInstanceMethod, GrowingULSwizzleClassMethod and growingul::Swizzle enter
+ their scope on their own; other replacements wrap their code like this:
+
+ @code
+
+    - (void)growingul_viewDidAppear:(BOOL)animated {
+        [self growingul_viewDidAppear:animated];
+        GrowingULSwizzleHookEnterScope(viewDidAppearHook);
+        [self trackAppearance];
+    }
+
+ @endcode
+ */
+
+/// Written by +instrumentationEnabled; read it with GrowingULSwizzleHookInstrumentationIsActive().
+FOUNDATION_EXPORT BOOL GrowingULSwizzleHookInstrumentationActive;
+
+/// One pass through a hook; index is 0 when the pass is not counted.
+typedef struct {
+    uint32_t index;
+    uint32_t depth;
+    uint64_t start;
+} GrowingULSwizzleHookScope;
+
+FOUNDATION_EXPORT GrowingULSwizzleHookScope GrowingULSwizzleHookScopeBegin(GrowingULSwizzleHook *_Nullable hook);
+FOUNDATION_EXPORT void GrowingULSwizzleHookScopeEnd(GrowingULSwizzleHookScope *scope);
+FOUNDATION_EXPORT uint64_t GrowingULSwizzleHookOriginalBegin(void);
+FOUNDATION_EXPORT void GrowingULSwizzleHookOriginalEnd(uint64_t start);
+
+static inline BOOL GrowingULSwizzleHookInstrumentationIsActive(void) {
+    return __atomic_load_n(&GrowingULSwizzleHookInstrumentationActive, __ATOMIC_RELAXED);
+}
+
+static inline GrowingULSwizzleHookScope GrowingULSwizzleHookScopeNone(void) {
+    GrowingULSwizzleHookScope scope = {0, 0, 0};
+    return scope;
+}
+
+static inline void GrowingULSwizzleHookScopeExit(GrowingULSwizzleHookScope *scope) {
+    if (scope->index) {
+        GrowingULSwizzleHookScopeEnd(scope);
+    }
+}
+
+static inline void GrowingULSwizzleHookOriginalExit(uint64_t *start) {
+    if (*start) {
+        GrowingULSwizzleHookOriginalEnd(*start);
+    }
+}
+
+/// Counts a call of hook, timed until the end of the enclosing block. hook is only evaluated while instrumentation
+/// is on; nil does not count.
+#define GrowingULSwizzleHookEnterScope(hook)                                                                        \
+    __attribute__((cleanup(GrowingULSwizzleHookScopeExit), unused)) GrowingULSwizzleHookScope _growingul_hookScope = \
+        GrowingULSwizzleHookInstrumentationIsActive() ? GrowingULSwizzleHookScopeBegin(hook)                        \
+                                                      : GrowingULSwizzleHookScopeNone()
+
+/// Evaluates expression, a call of the original implementation, and keeps its time out of the enclosing scope.
+#define GrowingULSwizzleHookCallOriginal(expression...)                                                \
+    ({                                                                                                  \
+        __attribute__((cleanup(GrowingULSwizzleHookOriginalExit), unused)) uint64_t _growingul_original = \
+            GrowingULSwizzleHookInstrumentationIsActive() ? GrowingULSwizzleHookOriginalBegin() : 0;     \
+        expression;                                                                                     \
+    })
+
+NS_ASSUME_NONNULL_END
@@ -41,6 +41,7 @@
 //  limitations under the License.
 
 #import <Foundation/Foundation.h>
+#import "GrowingULSwizzleHook.h"
 
 #pragma mark - Macros Based API
 
@@ -179,6 +180,8 @@ typedef void (*GrowingULSwizzleOriginalIMP)(void /* id, SEL, ... */ );
  Returns the original implementation of the swizzled method.
 
  It is actually either an original implementation if the swizzled class implements the method itself; or a super implementation fetched from one of the superclasses.
+
+ The implementation is published once when swizzling completes and read without locking afterwards; super implementations are memoized until GrowingULSwizzleMethodListsDidChange() is called, or until the implementation of the superclass method they were read from changes.
  
  @note You must always cast returned implementation to the appropriate function pointer when calling.
  
@@ -189,6 +192,9 @@ typedef void (*GrowingULSwizzleOriginalIMP)(void /* id, SEL, ... */ );
 /// The selector of the swizzled method.
 @property (nonatomic, readonly) SEL selector;
 
+/// The hook of the swizzled method, nil until swizzling completes; pass it to GrowingULSwizzleHookEnterScope.
+@property (atomic, strong, readonly) GrowingULSwizzleHook *hook;
+
 @end
 
 /**
@@ -295,6 +301,16 @@ typedef NS_ENUM(NSUInteger, GrowingULSwizzleMode) {
                         mode:(GrowingULSwizzleMode)mode
                          key:(const void *)key;
 
+/**
+ Same as +swizzleInstanceMethod:inClass:newImpFactory:mode:key:, returning the handle of the installed hook, which
+ can put the original implementation back, or nil if nothing was swizzled.
+ */
++(GrowingULSwizzleHook *)installHookForInstanceMethod:(SEL)selector
+                                              inClass:(Class)classToSwizzle
+                                        newImpFactory:(GrowingULSwizzleImpFactoryBlock)factoryBlock
+                                                 mode:(GrowingULSwizzleMode)mode
+                                                  key:(const void *)key;
+
 #pragma mark └ Swizzle Class method
 
 /**
@@ -345,6 +361,14 @@ typedef NS_ENUM(NSUInteger, GrowingULSwizzleMode) {
 
 @end
 
+/**
+ Invalidates the superclass implementations memoized by GrowingULSwizzleInfo for classes that do not implement the
+ swizzled method themselves. Swizzling APIs in this library call it. Implementations exchanged or replaced by other
+ means are noticed without it; call it after adding methods by other means (class_addMethod, class_replaceMethod on
+ a class that did not implement the method) to superclasses of classes swizzled here.
+ */
+FOUNDATION_EXPORT void GrowingULSwizzleMethodListsDidChange(void);
+
 #pragma mark - Implementation details
 // Do not write code that depends on anything below this line.
 
@@ -376,6 +400,7 @@ typedef NS_ENUM(NSUInteger, GrowingULSwizzleMode) {
         return ^GUSWReturnType (_GUSWDel2Arg(__unsafe_unretained id self, \
                                              GUSWArguments)) \
         { \
+            GrowingULSwizzleHookEnterScope(swizzleInfo.hook); \
             GUSWReplacement \
         }; \
      } \
@@ -398,12 +423,13 @@ typedef NS_ENUM(NSUInteger, GrowingULSwizzleMode) {
         return ^GUSWReturnType (_GUSWDel2Arg(__unsafe_unretained id self, \
                                              GUSWArguments)) \
         { \
+            GrowingULSwizzleHookEnterScope(swizzleInfo.hook); \
             GUSWReplacement \
         }; \
      }];
 
 #define _GUSWCallOriginal(arguments...) \
-    ((__typeof(originalImplementation_))[swizzleInfo \
-                                         getOriginalImplementation])(self, \
-                                                                     selector_, \
-                                                                     ##arguments)
+    GrowingULSwizzleHookCallOriginal(((__typeof(originalImplementation_))[swizzleInfo \
+                                                                          getOriginalImplementation])(self, \
+                                                                                                      selector_, \
+                                                                                                      ##arguments))
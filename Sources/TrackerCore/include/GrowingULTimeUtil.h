@@ -18,6 +18,43 @@
 //  limitations under the License.
 
 #import <Foundation/Foundation.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+ Clock readings in nanoseconds, callable from C and free of message sends and allocations.
+ */
+
+/// Time since boot, stopped while the device sleeps; use it for intervals. Same base as NSProcessInfo.systemUptime.
+static inline uint64_t GrowingULMonotonicTimeNanos(void) {
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+}
+
+/// Time since boot, including time asleep.
+static inline uint64_t GrowingULContinuousTimeNanos(void) {
+    return clock_gettime_nsec_np(CLOCK_MONOTONIC_RAW);
+}
+
+/// Time since 1970 from the system clock.
+static inline uint64_t GrowingULWallTimeNanos(void) {
+    return clock_gettime_nsec_np(CLOCK_REALTIME);
+}
+
+/// Offset from the continuous clock to the wall clock, 0 until first anchored. Use GrowingULEstimatedWallTimeNanos.
+FOUNDATION_EXPORT int64_t GrowingULWallClockOffsetNanos;
+
+/// Anchors the wall clock estimate to the continuous clock and returns the offset. Called on first use and again on
+/// NSSystemClockDidChangeNotification.
+FOUNDATION_EXPORT int64_t GrowingULWallClockAnchor(void);
+
+/// Wall clock derived from the continuous clock; it does not follow NTP slewing between clock-change notifications.
+static inline uint64_t GrowingULEstimatedWallTimeNanos(void) {
+    int64_t offset = __atomic_load_n(&GrowingULWallClockOffsetNanos, __ATOMIC_RELAXED);
+    if (__builtin_expect(offset == 0, 0)) {
+        offset = GrowingULWallClockAnchor();
+    }
+    return (uint64_t)((int64_t)GrowingULContinuousTimeNanos() + offset);
+}
 
 @interface GrowingULTimeUtil : NSObject
 
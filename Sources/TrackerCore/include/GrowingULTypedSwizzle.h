@@ -0,0 +1,95 @@
+//
+//  GrowingULTypedSwizzle.h
+//  GrowingAnalytics
+//
+//  Created by GrowingIO on 2026/10/17.
+//  Copyright (C) 2026 Beijing Yishu Technology Co., Ltd.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "GrowingULSwizzle.h"
+
+#if defined(__cplusplus) && defined(__OBJC__)
+#import <objc/runtime.h>
+#include <type_traits>
+#include <utility>
+
+/**
+ Objective-C++ helpers that swizzle with types checked by the compiler instead of by
+ blockIsCompatibleWithMethodType at runtime.
+
+ The method signature is written once, without self and _cmd; the replacement block type and the type of the
+ original implementation are derived from it, and a factory returning a block of any other type does not compile.
+ Installation goes through +growingul_swizzleMethod:withBlockFactory:error:, which does no signature parsing.
+
+ @code
+
+    using DidAppear = growingul::Swizzle<void(BOOL)>;
+    DidAppear::instance(UIViewController.class, @selector(viewDidAppear:), [](DidAppear::Original original) {
+        return ^(id controller, BOOL animated) {
+            original(controller, animated);
+            NSLog(@"after %@", controller);
+        };
+    });
+
+ @endcode
+ */
+namespace growingul {
+
+template <typename Signature>
+struct Swizzle;
+
+template <typename R, typename... Args>
+struct Swizzle<R(Args...)> {
+    using Implementation = R (*)(id, SEL, Args...);
+    using Replacement = R (^)(id self, Args... args);
+
+    /// Typed handle on the replaced implementation, callable as original(self, args...).
+    struct Original {
+        Implementation imp;
+        SEL selector;
+
+        R operator()(id self, Args... args) const {
+            return GrowingULSwizzleHookCallOriginal(imp(self, selector, std::forward<Args>(args)...));
+        }
+    };
+
+    template <typename Factory>
+    static BOOL instance(Class cls, SEL selector, Factory factory, NSError **error = nullptr) {
+        static_assert(std::is_convertible<decltype(factory(std::declval<Original>())), Replacement>::value,
+                      "the factory must return a block of type R (^)(id self, Args...) matching the signature");
+        // the replacement is wrapped so that GrowingULSwizzleHook instrumentation can time it
+        __block __unsafe_unretained GrowingULSwizzleHook *hook = nil;
+        BOOL swizzled = [cls growingul_swizzleMethod:selector
+                                    withBlockFactory:^id(IMP imp) {
+                                        Replacement replacement = factory(Original{(Implementation)imp, selector});
+                                        return ^R(id self, Args... args) {
+                                            GrowingULSwizzleHookEnterScope(hook);
+                                            return replacement(self, std::forward<Args>(args)...);
+                                        };
+                                    }
+                                               error:error];
+        if (swizzled) {
+            hook = [GrowingULSwizzleHook hookForClass:cls selector:selector];
+        }
+        return swizzled;
+    }
+
+    template <typename Factory>
+    static BOOL classMethod(Class cls, SEL selector, Factory factory, NSError **error = nullptr) {
+        return instance(object_getClass(cls), selector, factory, error);
+    }
+};
+
+}  // namespace growingul
+#endif
@@ -20,11 +20,33 @@
 #import "GrowingTargetConditionals.h"
 
 #if Growing_USE_UIKIT
+/**
+ On the main thread growingul_keyWindow is cached and only looked up again after a window or scene key/visibility
+ notification. growingul_topViewController is cached the same way once GrowingULEnableTopViewControllerCache() has
+ been called by whoever observes view controller appearance (GrowingULViewControllerLifecycle does), and is
+ walked on every call before that and while any GrowingULSwizzleHook is suspended.
+ */
 @interface UIApplication (GrowingUtilsTrackerCore)
 
 - (nullable UIWindow *)growingul_keyWindow;
 - (nullable UIViewController *)growingul_topViewController;
+/// From the GrowingULEnvironment snapshot once it has geometry.
 - (CGFloat)growingul_statusBarHeight;
+/// Reads the status bar height now, main thread only.
+- (CGFloat)growingul_currentStatusBarHeight;
 
 @end
+
+/// Main thread only. The caller promises to call GrowingULInvalidateTopViewControllerCache() whenever a view
+/// controller appears or disappears.
+FOUNDATION_EXPORT void GrowingULEnableTopViewControllerCache(void);
+
+/// Main thread only.
+FOUNDATION_EXPORT void GrowingULInvalidateTopViewControllerCache(void);
+
+/// Debug aid: when enabled every cached lookup is compared with a full walk, mismatches are counted and the walked
+/// result is returned and cached.
+FOUNDATION_EXPORT void GrowingULSetLookupCacheVerificationEnabled(BOOL enabled);
+
+FOUNDATION_EXPORT NSUInteger GrowingULLookupCacheMismatchCount(void);
 #endif